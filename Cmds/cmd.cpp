@@ -16,6 +16,7 @@
 
 #include "cmd.h"
 #include "../Utils/buffers.h"
+#include "../Utils/deferredDump.h"
 
 using namespace std;
 
@@ -241,12 +242,11 @@ Cmd::Dump(DumpFilename filename, string fileHdr) const
 {
     FILE *fp;
 
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    fp = DeferredDump::Open(filename);
 
     fprintf(fp, "This file: %s\n", filename.c_str());
     fprintf(fp, "%s\n\n", fileHdr.c_str());
-    fclose(fp);
+    DeferredDump::Close(fp);
 
     Buffers::Dump(filename, (uint8_t *)mCmdBuf->GetBuffer(), 0, ULONG_MAX,
         mCmdBuf->GetBufSize(), "Cmd contents:");
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "cmdTemplate.h"
+
+
+CmdTemplate::CmdTemplate()
+{
+    // This constructor will throw
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+CmdTemplate::CmdTemplate(SharedCmdPtr cmd, uint32_t lbaSize)
+{
+    if (cmd->GetCmdSizeB() != 64)
+        throw FrmwkEx(HERE, "Only 64B cmds are supported");
+
+    mCmd = cmd;
+    mDW = (uint32_t *)cmd->GetCmd()->GetBuffer();
+
+    memset(&mIO, 0, sizeof(mIO));
+    mIO.bit_mask = (send_64b_bitmask)(cmd->GetPrpBitmask() |
+        cmd->GetMetaBitmask());
+    mIO.meta_buf_id = cmd->GetMetaBufferID();
+    mIO.data_buf_size = cmd->GetPrpBufferSize();
+    mIO.data_buf_ptr = cmd->GetROPrpBuffer();
+    mIO.cmd_buf_ptr = cmd->GetCmd()->GetBuffer();
+    mIO.data_dir = cmd->GetDataDir();
+    mLBASize = lbaSize;
+    mMaxDataSize = cmd->GetPrpBufferSize();
+    mTag = 0;
+    LOG_NRM("Created template of cmd opcode 0x%02X, payload size 0x%04X",
+        cmd->GetOpcode(), (uint32_t)cmd->GetPrpBufferSize());
+}
+
+
+CmdTemplate::~CmdTemplate()
+{
+}
+
+
+void
+CmdTemplate::SetNLB(uint16_t nlb)
+{
+    uint64_t dataSize = (((uint64_t)nlb + 1) * mLBASize);
+
+    if (mLBASize == 0)
+        throw FrmwkEx(HERE, "Template was created w/o an LBA size");
+    if (dataSize > mMaxDataSize) {
+        throw FrmwkEx(HERE, "NLB %d requires 0x%lX bytes, buffer holds 0x%X",
+            nlb, dataSize, mMaxDataSize);
+    }
+
+    mDW[12] = ((mDW[12] & 0xffff0000) | nlb);
+    mIO.data_buf_size = dataSize;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _CMDTEMPLATE_H_
+#define _CMDTEMPLATE_H_
+
+#include "cmd.h"
+
+class CmdTemplate;    // forward definition
+typedef boost::shared_ptr<CmdTemplate>      SharedCmdTemplatePtr;
+
+
+/**
+* This class turns a fully configured cmd, i.e. a Write, Read or DatasetMgmt,
+* into a template which may be submitted over and over again at negligible
+* host cost via SQ::SendTemplate(). Everything about the cmd is resolved once
+* at construction; thereafter only the fields which vary per submission are
+* patched directly within the cmd's own 64B image, w/o logging, allocating
+* or making virtual calls. Patching the cmd's image, rather than a copy of it,
+* keeps Cmd::Dump() and the Get*() accessors of the underlying cmd coherent.
+*
+* dnvme builds the PRP entries and assigns the CID of every cmd it is sent,
+* thus the data buffer bound to the cmd by SetPrpBuffer() prior to creating
+* the template is used for every submission. When the NLB is to vary, bind a
+* buffer large enough for the largest NLB; SetNLB() then only hands dnvme the
+* portion of that buffer the cmd transfers.
+*
+* @note This class may throw exceptions.
+*/
+class CmdTemplate
+{
+public:
+    /**
+     * @param cmd Pass the cmd to submit repeatedly, any data and meta buffers
+     *      must be bound to it beforehand.
+     * @param lbaSize Pass the number of bytes of the data buffer consumed per
+     *      LBA, i.e. the LBA data size plus any interleaved meta data. Pass 0
+     *      to prohibit changing the NLB via SetNLB().
+     */
+    CmdTemplate(SharedCmdPtr cmd, uint32_t lbaSize = 0);
+    virtual ~CmdTemplate();
+
+    SharedCmdPtr GetCmd() const { return mCmd; }
+
+    /// Patch CDW10 and CDW11 of an NVM cmd
+    void SetSLBA(uint64_t lba)
+        { mDW[10] = (uint32_t)lba; mDW[11] = (uint32_t)(lba >> 32); }
+
+    /**
+     * Patch the NLB within CDW12 of an NVM cmd and shrink the data transfer
+     * to match. A separate meta buffer must be large enough for the largest
+     * NLB ever requested, it is not checked.
+     * @note Throws if the data buffer bound to the cmd can't hold (nlb + 1)
+     *      LBA's, or if the template was created w/o an LBA size.
+     * @param nlb Pass the 0-based number of logical blks
+     */
+    void SetNLB(uint16_t nlb);
+
+    /**
+     * Patch any DWORD of the cmd, i.e. CDW10.NR of a DatasetMgmt cmd.
+     * @param newVal Pass the new DWORD value
+     * @param whichDW Pass [1->15] which DWORD to set; DWORD 0 holds the
+     *      opcode and CID.
+     */
+    void SetDword(uint32_t newVal, uint8_t whichDW) { mDW[whichDW] = newVal; }
+
+    /// An opaque value for the template's owner, i.e. an index into its pool
+    void SetTag(uint32_t tag) { mTag = tag; }
+    uint32_t GetTag() const { return mTag; }
+
+
+private:
+    CmdTemplate();
+
+    SharedCmdPtr mCmd;
+    /// The cmd's own image, viewed as DWORDs
+    uint32_t *mDW;
+    /// Everything dnvme needs to be told, other than which SQ to send to
+    struct nvme_64b_send mIO;
+    /// Bytes of the data buffer consumed per LBA, 0 prohibits SetNLB()
+    uint32_t mLBASize;
+    /// Size of the data buffer bound to the cmd
+    uint32_t mMaxDataSize;
+    /// Owner defined, see SetTag()
+    uint32_t mTag;
+
+    friend class SQ;
+};
+
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "getLogPage.h"
 #include "globals.h"
+#include "../Utils/deferredDump.h"
 
 #define NUMD_BITMASK        0x0fff
 
@@ -113,8 +114,7 @@ GetLogPage::Dump(DumpFilename filename, string fileHdr) const
     Cmd::Dump(filename, fileHdr);
 
     // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    fp = DeferredDump::Open(filename);
 
     fprintf(fp, "\n------------------------------------------------------\n");
     fprintf(fp, "----Detailed decoding of the cmd payload as follows---\n");
@@ -142,7 +142,7 @@ GetLogPage::Dump(DumpFilename filename, string fileHdr) const
         break;
     }
 
-    fclose(fp);
+    DeferredDump::Close(fp);
 }
 
 
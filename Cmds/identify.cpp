@@ -17,6 +17,7 @@
 #include <string.h>
 #include "identify.h"
 #include "../Utils/buffers.h"
+#include "../Utils/deferredDump.h"
 #include "../Utils/fileSystem.h"
 #include "../Singletons/regDefs.h"
 #include "../globals.h"
@@ -144,8 +145,7 @@ Identify::Dump(DumpFilename filename, string fileHdr) const
     Cmd::Dump(filename, fileHdr);
 
     // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    fp = DeferredDump::Open(filename);
 
     fprintf(fp, "\n------------------------------------------------------\n");
     fprintf(fp, "----Detailed decoding of the cmd payload as follows---\n");
@@ -159,7 +159,7 @@ Identify::Dump(DumpFilename filename, string fileHdr) const
         for (int i = 0; i < IDNAMESPC_FENCE; i++)
             Dump(fp, i, mIdNamespcType);
     }
-    fclose(fp);
+    DeferredDump::Close(fp);
 }
 
 
@@ -22,6 +22,7 @@
 #include "../Utils/kernelAPI.h"
 #include "../Utils/irq.h"
 #include "../Utils/io.h"
+#include "../Utils/aerService.h"
 #include "../Cmds/asyncEventReq.h"
 #include "../Cmds/asyncEventReqDefs.h"
 #include "../Cmds/getLogPage.h"
@@ -43,9 +44,9 @@ VerifyEventQueueing_r10b::VerifyEventQueueing_r10b(
     // No string size limit for the long description
     mTestDesc.SetLong(
         "Reset ctrlr to cause a clearing of DUT state. Ring doorbell #1. "
-        "Delay 5 sec and verify no CE's exist in ASQ. Issue async event and "
-        "reap immiately then verify a single CE exists for 1 async event,and, "
-        "validate CE.DW0 for proper error.");
+        "Delay 5 sec and verify no CE's exist in ASQ. Keep 1 async event "
+        "outstanding via an AER service then verify a single async event is "
+        "delivered, and, validate CE.DW0 for proper error.");
 }
 
 
@@ -104,9 +105,9 @@ VerifyEventQueueing_r10b::RunCoreTest()
      *  \endverbatim
      */
     uint32_t isrCount;
-    uint32_t ceRemain;
-    uint32_t numReaped;
     uint32_t numCE;
+    AsyncEvent event;
+    string work;
 
     if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
         throw FrmwkEx(HERE);
@@ -139,59 +140,41 @@ VerifyEventQueueing_r10b::RunCoreTest()
         throw FrmwkEx(HERE, "0 CE's expected in ACQ but found %d CE's", numCE);
     }
 
-    LOG_NRM("Issue one async event ");
-    SendAsyncEventRequests(asq, 1);
+    LOG_NRM("Keep one async event outstanding");
+    AsyncEventWaiter waiter;    // must outlive the service notifying it
+    AERService aer(mGrpName, mTestName, asq, acq);
+    aer.Attach(waiter);
+    aer.Start(1);
 
-    LOG_NRM("verify CE exists in ACQ for invalid SQID doorbell write");
-    if (acq->ReapInquiryWaitSpecify(CALC_TIMEOUT_ms(1), 1, numCE, isrCount)
-        == false) {
+    LOG_NRM("verify async event delivered for invalid SQID doorbell write");
+    if (waiter.Wait(CALC_TIMEOUT_ms(1), event) == false) {
+        aer.Stop();
         acq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
             "acq.fail.1rinq"), "Dump Entire ACQ");
-        throw FrmwkEx(HERE, "1 CE expected in ACQ but found %d CEs", numCE);
+        if (aer.GetFailure(work))
+            throw FrmwkEx(HERE, work);
+        throw FrmwkEx(HERE, "1 async event expected but none delivered");
     }
+    aer.Stop();
 
-    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
-    if ((numReaped = acq->Reap(ceRemain, ceMem, isrCount, numCE, true))
-        != 1) {
+    if ((numCE = aer.GetNumEvents()) != 1) {
         acq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
             "acq.fail.1reap"), "Dump Entire ACQ");
-        throw FrmwkEx(HERE, "Unable to reap on ACQ");
+        throw FrmwkEx(HERE, "1 async event expected but %d delivered", numCE);
     }
 
-    union CE *ce = (union CE *)ceMem->GetBuffer();
-    if (ce->n.async.asyncEventType != EVENT_TYPE_ERROR_STS) {
+    if (event.type != EVENT_TYPE_ERROR_STS) {
         acq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
             "acq.fail.sts"), "Dump Entire ACQ");
         throw FrmwkEx(HERE, "Invalid async event error status, "
             "(Expected : Received) :: (%d : %d)", EVENT_TYPE_ERROR_STS,
-            ce->n.async.asyncEventType);
-    } else if (ce->n.async.asyncEventInfo != ERR_STS_INVALID_SQ) {
+            event.type);
+    } else if (event.info != ERR_STS_INVALID_SQ) {
         acq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
             "acq.fail.sc"), "Dump Entire ACQ");
         throw FrmwkEx(HERE, "Invalid async event info, "
             "(Expected : Received) :: (%d : %d)", ERR_STS_INVALID_SQ,
-            ce->n.async.asyncEventInfo);
-    }
-}
-
-
-void
-VerifyEventQueueing_r10b::SendAsyncEventRequests(SharedASQPtr &asq, uint32_t nCmds)
-{
-    uint16_t uniqueId;
-    string work;
-
-    LOG_NRM("Create aync event request cmd");
-    SharedAsyncEventReqPtr asyncEventReqCmd =
-        SharedAsyncEventReqPtr(new AsyncEventReq());
-
-    for (uint32_t i = 0; i < nCmds; i++) {
-        LOG_NRM("Send the async event request cmd to hdw via ASQ");
-        asq->Send(asyncEventReqCmd, uniqueId);
-        work = str(boost::format("asyncEventReq.%d") % i);
-        asq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
-            "asq", work), "Before doorbell ring");
-        asq->Ring();
+            event.info);
     }
 }
 
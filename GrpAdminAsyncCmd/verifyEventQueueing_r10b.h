@@ -56,7 +56,6 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     // Adding a member variable? Then edit the copy constructor and operator=().
     ///////////////////////////////////////////////////////////////////////////
-    void SendAsyncEventRequests(SharedASQPtr &asq, uint32_t nCmds);
     void InvalidSQWriteDoorbell();
     void ReadLogPage(SharedACQPtr &acq, SharedASQPtr &asq, uint8_t logId);
 };
@@ -101,7 +101,6 @@ FunctionalityBare_r10b::RunCoreTest()
      */
     string work;
     bool enableLog;
-    ConstSharedIdentifyPtr namSpcPtr;
 
     // Lookup objs which were created in a prior test within group
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
@@ -134,12 +133,12 @@ FunctionalityBare_r10b::RunCoreTest()
     uint64_t dpArrSize = sizeof(dataPat) / sizeof(dataPat[0]);
 
     LOG_NRM("Seeking all bare namspc's.");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
         LOG_NRM("Processing for BARE name space id #%d", bare[i]);
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t ncap = nsIdx.ncap[bare[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         uint64_t maxWrBlks = maxDtXferSz / lbaDataSize;
 
         writeMem->Init(maxWrBlks * lbaDataSize);
@@ -103,7 +103,6 @@ FunctionalityMeta_r10b::RunCoreTest()
      */
     string work;
     bool enableLog;
-    ConstSharedIdentifyPtr namSpcPtr;
     SharedIOSQPtr iosq;
     SharedIOCQPtr iocq;
     uint64_t maxWrBlks;
@@ -144,6 +143,7 @@ FunctionalityMeta_r10b::RunCoreTest()
         (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
 
     LOG_NRM("Seeking all meta namspc's.");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> meta = gInformative->GetMetaNamespaces();
     for (size_t i = 0; i < meta.size(); i++) {
         LOG_NRM("Processing meta namspc id #%d of %ld", meta[i], meta.size());
@@ -161,19 +161,18 @@ FunctionalityMeta_r10b::RunCoreTest()
         CreateIOQs(asq, acq, IOQ_ID, iosq, iocq);
 
         LOG_NRM("Get LBA format and lba data size for namespc #%d", meta[i]);
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(meta[i]);
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
-        uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
-        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+        uint16_t ms = nsIdx.ms[meta[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[meta[i] - 1];
+        uint64_t ncap = nsIdx.ncap[meta[i] - 1];
         uint64_t metaBuffSz = 0;
 
         LOG_NRM("Set read and write buffers based on the namspc type");
-        switch (gInformative->IdentifyNamespace(namSpcPtr)) {
+        switch (nsIdx.type[meta[i] - 1]) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
             maxWrBlks = maxDtXferSz / lbaDataSize;
-            metaBuffSz = maxWrBlks * lbaFormat.MS;
+            metaBuffSz = maxWrBlks * ms;
             if (gRsrcMngr->SetMetaAllocSize(metaBuffSz) == false)
                 throw FrmwkEx(HERE);
             LOG_NRM("Max rd/wr blks %ld using separate meta buff of ncap %ld",
@@ -184,11 +183,11 @@ FunctionalityMeta_r10b::RunCoreTest()
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            maxWrBlks = maxDtXferSz / (lbaDataSize + lbaFormat.MS);
+            maxWrBlks = maxDtXferSz / (lbaDataSize + ms);
             LOG_NRM("Max rd/wr blks %ld using integrated meta buff of ncap %ld",
                 maxWrBlks, ncap);
-            writeMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
-            readMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
+            writeMem->Init(maxWrBlks * (lbaDataSize + ms));
+            readMem->Init(maxWrBlks * (lbaDataSize + ms));
             break;
         case Informative::NS_E2ES:
         case Informative::NS_E2EI:
@@ -211,16 +210,16 @@ FunctionalityMeta_r10b::RunCoreTest()
             if ((sLBA + maxWrBlks) >= ncap) {
                 maxWrBlks = ncap - sLBA;
                 LOG_NRM("Resize max write blocks to #%ld", maxWrBlks);
-                ResizeDataBuf(readCmd, writeCmd, namSpcPtr, maxWrBlks,
+                ResizeDataBuf(readCmd, writeCmd, meta[i], maxWrBlks,
                     prpBitmask);
-                metaBuffSz = maxWrBlks * lbaFormat.MS;
+                metaBuffSz = maxWrBlks * ms;
             }
             LOG_NRM("Sending #%ld blks starting at #%ld", maxWrBlks, sLBA);
             for (uint64_t nLBA = 0; nLBA < maxWrBlks; nLBA++) {
                 writeMem->SetDataPattern(dataPat[nLBA % dpArrSize],
                     (sLBA + nLBA + 1), (nLBA * lbaDataSize), lbaDataSize);
                 writeCmd->SetMetaDataPattern(dataPat[nLBA % dpArrSize],
-                    (sLBA + nLBA + 1), (nLBA * lbaFormat.MS), lbaFormat.MS);
+                    (sLBA + nLBA + 1), (nLBA * ms), ms);
             }
             writeCmd->SetSLBA(sLBA);
             readCmd->SetSLBA(sLBA);
@@ -323,16 +322,17 @@ FunctionalityMeta_r10b::CreateIOQs(SharedASQPtr asq, SharedACQPtr acq,
 
 void
 FunctionalityMeta_r10b::ResizeDataBuf(SharedReadPtr &readCmd,
-    SharedWritePtr &writeCmd, ConstSharedIdentifyPtr namSpcPtr,
+    SharedWritePtr &writeCmd, uint32_t nsid,
     uint64_t maxWrBlks, send_64b_bitmask prpBitmask)
 {
-    LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
-    uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
+    uint16_t ms = nsIdx.ms[nsid - 1];
+    uint64_t lbaDataSize = nsIdx.lbaDataSize[nsid - 1];
 
     SharedMemBufferPtr readMem = readCmd->GetRWPrpBuffer();
     SharedMemBufferPtr writeMem = writeCmd->GetRWPrpBuffer();
 
-    switch (gInformative->IdentifyNamespace(namSpcPtr)) {
+    switch (nsIdx.type[nsid - 1]) {
     case Informative::NS_BARE:
         throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
     case Informative::NS_METAS:
@@ -342,8 +342,8 @@ FunctionalityMeta_r10b::ResizeDataBuf(SharedReadPtr &readCmd,
         break;
     case Informative::NS_METAI:
         LOG_NRM("Resized max rd/wr blks to %ld for integrated meta", maxWrBlks);
-        writeMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
-        readMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
+        writeMem->Init(maxWrBlks * (lbaDataSize + ms));
+        readMem->Init(maxWrBlks * (lbaDataSize + ms));
         break;
     case Informative::NS_E2ES:
     case Informative::NS_E2EI:
@@ -103,7 +103,6 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
      */
     uint64_t nsze;
     string work;
-    ConstSharedIdentifyPtr namSpcPtr;
     SharedIOSQPtr iosq;
     SharedIOCQPtr iocq;
 
@@ -116,15 +115,15 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
 
     SharedASQPtr asq = SharedASQPtr(new ASQ(gDutFd));
     asq->Init(5);
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> meta = gInformative->GetMetaNamespaces();
     for (size_t i = 0; i < meta.size(); i++) {
         if (gCtrlrConfig->SetState(ST_DISABLE) == false)
             throw FrmwkEx(HERE);
 
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(meta[i]);
-        nsze = namSpcPtr->GetValue(IDNAMESPC_NSZE);
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
+        nsze = nsIdx.nsze[meta[i] - 1];
+        uint16_t ms = nsIdx.ms[meta[i] - 1];
 
         // All queues will use identical IRQ vector
         IRQ::SetAnySchemeSpecifyNum(1);
@@ -138,7 +137,7 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
 
         LOG_NRM("Create memory to contain read payload");
         SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[meta[i] - 1];
 
         LOG_NRM("Create a read cmd to read data from namspc %d", meta[i]);
         SharedReadPtr readCmd = SharedReadPtr(new Read());
@@ -146,16 +145,15 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
             (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
 
         LOG_NRM("Determine namspc type and allocate meta buffer as necesssary");
-        Informative::NamspcType nsType =
-            gInformative->IdentifyNamespace(namSpcPtr);;
+        Informative::NamspcType nsType = nsIdx.type[meta[i] - 1];
         switch (nsType) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
             LOG_NRM("Meta mamespace with separate buffer. meta size = %d",
-                lbaFormat.MS);
+                ms);
             readMem->Init(RD_NUM_BLKS * lbaDataSize);
-            if (gRsrcMngr->SetMetaAllocSize(RD_NUM_BLKS * lbaFormat.MS)
+            if (gRsrcMngr->SetMetaAllocSize(RD_NUM_BLKS * ms)
                 == false) {
                 throw FrmwkEx(HERE);
             }
@@ -163,8 +161,8 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
             break;
         case Informative::NS_METAI:
             LOG_NRM("Meta mamespace with extended LBA size = %ld.",
-                (lbaDataSize + lbaFormat.MS));
-            readMem->Init(RD_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
+                (lbaDataSize + ms));
+            readMem->Init(RD_NUM_BLKS * (lbaDataSize + ms));
             break;
         case Informative::NS_E2ES:
         case Informative::NS_E2EI:
@@ -96,19 +96,17 @@ ProtInfoIgnoreBare_r10b::RunCoreTest()
      * \endverbatim
      */
     char context[256];
-    ConstSharedIdentifyPtr namSpcPtr;
 
     // Lookup objs which were created in a prior test within group
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
     SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-
         LOG_NRM("Create memory to contain read payload");
         SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         readMem->Init(lbaDataSize);
 
         LOG_NRM("Create a read cmd to read data from namspc %d", bare[i]);
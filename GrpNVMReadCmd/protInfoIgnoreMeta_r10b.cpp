@@ -95,7 +95,6 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
      * \endverbatim
      */
     string context;
-    ConstSharedIdentifyPtr namSpcPtr;
     SharedIOSQPtr iosq;
     SharedIOCQPtr iocq;
     send_64b_bitmask prpBitmask = (send_64b_bitmask)
@@ -111,6 +110,7 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
     asq->Init(5);
 
     LOG_NRM("Get all the supported meta namespaces");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> meta = gInformative->GetMetaNamespaces();
     for (size_t i = 0; i < meta.size(); i++) {
         if (gCtrlrConfig->SetState(ST_DISABLE) == false)
@@ -127,9 +127,8 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
         CreateIOQs(asq, acq, IOQ_ID, iosq, iocq);
 
         LOG_NRM("Get LBA format and lba data size for namespc #%d", meta[i]);
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(meta[i]);
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
-        uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+        uint16_t ms = nsIdx.ms[meta[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[meta[i] - 1];
 
         LOG_NRM("Create a read cmd to read data from namspc %d", meta[i]);
         SharedReadPtr readCmd = SharedReadPtr(new Read());
@@ -137,19 +136,18 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
         LOG_NRM("Create memory to contain read payload");
         SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
 
-        Informative::NamspcType
-            nsType = gInformative->IdentifyNamespace(namSpcPtr);
+        Informative::NamspcType nsType = nsIdx.type[meta[i] - 1];
         switch (nsType) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
             readMem->Init(lbaDataSize);
-            if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
+            if (gRsrcMngr->SetMetaAllocSize(ms) == false)
                 throw FrmwkEx(HERE);
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            readMem->Init(lbaDataSize + lbaFormat.MS);
+            readMem->Init(lbaDataSize + ms);
             break;
         case Informative::NS_E2ES:
         case Informative::NS_E2EI:
@@ -94,20 +94,18 @@ IgnoreMetaPtrBare_r10b::RunCoreTest()
      * \endverbatim
      */
     string work;
-    ConstSharedIdentifyPtr namSpcPtr;
 
     LOG_NRM("Lookup objs which were created in a prior test within group");
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
     SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
 
     LOG_NRM("For all bare namspc's issue cmd with non-zero meta ptr");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-
         LOG_NRM("Setup write cmd's values that won't change per namspc");
         SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         writeMem->Init(lbaDataSize);
 
         SharedWritePtr writeCmd = SharedWritePtr(new Write());
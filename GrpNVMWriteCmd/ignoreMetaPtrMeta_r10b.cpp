@@ -95,22 +95,20 @@ IgnoreMetaPtrMeta_r10b::RunCoreTest()
      * \endverbatim
      */
     string work;
-    ConstSharedIdentifyPtr namSpcPtr;
 
     LOG_NRM("Lookup objs which were created in a prior test within group");
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
     SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
 
     LOG_NRM("For all imeta namspc's issue write cmd with non-zero meta ptr");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> imeta = gInformative->GetMetaINamespaces();
     for (size_t i = 0; i < imeta.size(); i++) {
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(imeta[i]);
-
         LOG_NRM("Setup write cmd's values that won't change per namspc");
         SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
-        writeMem->Init(lbaDataSize + lbaFormat.MS);
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[imeta[i] - 1];
+        uint16_t ms = nsIdx.ms[imeta[i] - 1];
+        writeMem->Init(lbaDataSize + ms);
 
         SharedWritePtr writeCmd = SharedWritePtr(new Write());
         send_64b_bitmask prpBitmask = (send_64b_bitmask)
@@ -100,20 +100,19 @@ LBAOutOfRangeBare_r10b::RunCoreTest()
      */
     uint64_t nsze;
     char work[256];
-    ConstSharedIdentifyPtr namSpcPtr;
 
     // Lookup objs which were created in a prior test within group
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
     SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-        nsze = namSpcPtr->GetValue(IDNAMESPC_NSZE);
+        nsze = nsIdx.nsze[bare[i] - 1];
 
         LOG_NRM("Create memory to contain write payload");
         SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         writeMem->Init(WR_NUM_BLKS * lbaDataSize);
 
         LOG_NRM("Create a write cmd to write data to namspc %d", bare[i]);
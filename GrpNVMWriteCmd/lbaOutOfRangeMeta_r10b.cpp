@@ -102,7 +102,6 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
      */
     uint64_t nsze;
     string work;
-    ConstSharedIdentifyPtr namSpcPtr;
     SharedIOSQPtr iosq;
     SharedIOCQPtr iocq;
 
@@ -115,15 +114,15 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
 
     SharedASQPtr asq = SharedASQPtr(new ASQ(gDutFd));
     asq->Init(5);
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> meta = gInformative->GetMetaNamespaces();
     for (size_t i = 0; i < meta.size(); i++) {
         if (gCtrlrConfig->SetState(ST_DISABLE) == false)
             throw FrmwkEx(HERE);
 
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(meta[i]);
-        nsze = namSpcPtr->GetValue(IDNAMESPC_NSZE);
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
+        nsze = nsIdx.nsze[meta[i] - 1];
+        uint16_t ms = nsIdx.ms[meta[i] - 1];
 
         // All queues will use identical IRQ vector
         IRQ::SetAnySchemeSpecifyNum(1);
@@ -137,28 +136,27 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
 
         LOG_NRM("Create memory to contain write payload");
         SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
-        uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[meta[i] - 1];
 
         LOG_NRM("Create a write cmd to write data to namspc %d", meta[i]);
         SharedWritePtr writeCmd = SharedWritePtr(new Write());
         send_64b_bitmask prpBitmask = (send_64b_bitmask)
             (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
 
-        Informative::NamspcType nsType =
-            gInformative->IdentifyNamespace(namSpcPtr);;
+        Informative::NamspcType nsType = nsIdx.type[meta[i] - 1];
         switch (nsType) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
             writeMem->Init(WR_NUM_BLKS * lbaDataSize);
-            if (gRsrcMngr->SetMetaAllocSize(WR_NUM_BLKS * lbaFormat.MS)
+            if (gRsrcMngr->SetMetaAllocSize(WR_NUM_BLKS * ms)
                 == false) {
                 throw FrmwkEx(HERE);
             }
             writeCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            writeMem->Init(WR_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
+            writeMem->Init(WR_NUM_BLKS * (lbaDataSize + ms));
             break;
         case Informative::NS_E2ES:
         case Informative::NS_E2EI:
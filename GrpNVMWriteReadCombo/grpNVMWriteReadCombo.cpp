@@ -26,6 +26,7 @@
 #include "startingLBAMeta_r10b.h"
 #include "nlbaMeta_r10b.h"
 #include "prp2Rsvd_r10b.h"
+#include "lbaTagSweep_r10b.h"
 
 namespace GrpNVMWriteReadCombo {
 
@@ -46,6 +47,7 @@ GrpNVMWriteReadCombo::GrpNVMWriteReadCombo(size_t grpNum) :
         APPEND_TEST_AT_YLEVEL(StartingLBABare_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_YLEVEL(NLBABare_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_YLEVEL(DatasetMgmt_r10b, GrpNVMWriteReadCombo)
+        APPEND_TEST_AT_YLEVEL(LBATagSweep_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(StartingLBAMeta_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(NLBAMeta_r10b, GrpNVMWriteReadCombo)
         APPEND_TEST_AT_XLEVEL(PRP2Rsvd_r10b, GrpNVMWriteReadCombo)
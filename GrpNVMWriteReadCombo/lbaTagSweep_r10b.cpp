@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/format.hpp>
+#include "lbaTagSweep_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Cmds/write.h"
+#include "../Utils/io.h"
+
+#define CDW12_NLB_BITS          16
+
+
+namespace GrpNVMWriteReadCombo {
+
+
+LBATagSweep_r10b::LBATagSweep_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 6");
+    mTestDesc.SetShort(     "Sweep bare namspcs w/ LBA tagged data, find lost blks.");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "For all bare namspcs from Identify.NN, determine Identify.NCAP; For "
+        "each namspc issue write cmds each sending Identify.MDTS, or 256 KB if "
+        "unlimited, amount of data from LBA 0 to (Identify.NCAP - 1). Every "
+        "block embeds the NSID and LBA it is written to, a write generation "
+        "of 1 and a CRC32C of the block. Then overwrite every other write "
+        "cmd's worth of blocks with generation 2. After all writing completes "
+        "issue correlating read cmds through the same range verifying every "
+        "block is intact, belongs to the NSID and LBA it was read from and "
+        "holds the generation last written to it, i.e. is neither stale, "
+        "misplaced nor corrupt.");
+}
+
+
+LBATagSweep_r10b::~LBATagSweep_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+LBATagSweep_r10b::
+LBATagSweep_r10b(const LBATagSweep_r10b &other) :
+    Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+LBATagSweep_r10b &
+LBATagSweep_r10b::operator=(const LBATagSweep_r10b
+    &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+LBATagSweep_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+LBATagSweep_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     * \endverbatim
+     */
+    string work;
+    bool enableLog;
+
+    // Lookup objs which were created in a prior test within group
+    SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
+    SharedIOCQPtr iocq = CAST_TO_IOCQ(gRsrcMngr->GetObj(IOCQ_GROUP_ID));
+
+    ConstSharedIdentifyPtr idCmdCtrlr = gInformative->GetIdentifyCmdCtrlr();
+    uint32_t maxDtXferSz = idCmdCtrlr->GetMaxDataXferSize();
+    if (maxDtXferSz == 0)
+        maxDtXferSz = MAX_DATA_TX_SIZE;
+
+    LOG_NRM("Prepare cmds to be send through Q's.");
+    SharedWritePtr writeCmd = SharedWritePtr(new Write());
+    SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    SharedReadPtr readCmd = SharedReadPtr(new Read());
+    SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+
+    LOG_NRM("Seeking all bare namspc's.");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
+    vector<uint32_t> bare = gInformative->GetBareNamespaces();
+    for (size_t i = 0; i < bare.size(); i++) {
+        LOG_NRM("Processing for BARE name space id #%d", bare[i]);
+        uint64_t ncap = nsIdx.ncap[bare[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
+        uint64_t maxWrBlks = MIN((maxDtXferSz / lbaDataSize),
+            (1 << CDW12_NLB_BITS));
+
+        writeMem->InitHugePage(maxWrBlks * lbaDataSize);
+        writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+        writeCmd->SetNSID(bare[i]);
+        CmdTemplate writeTmpl(writeCmd, lbaDataSize);
+
+        readMem->InitHugePage(maxWrBlks * lbaDataSize);
+        readCmd->SetPrpBuffer(prpBitmask, readMem);
+        readCmd->SetNSID(bare[i]);
+        CmdTemplate readTmpl(readCmd, lbaDataSize);
+
+        // Generation 1 everywhere, thereafter generation 2 in every other
+        // chunk. Misdirected writes of either pass, and overwrites which are
+        // dropped or land elsewhere, all surface when reading back.
+        for (uint32_t gen = 1; gen <= 2; gen++) {
+            LOG_NRM("Writing generation %d to #%ld blks", gen, ncap);
+            uint64_t chunk = 0;
+            for (uint64_t slba = 0; slba < ncap; slba += maxWrBlks, chunk++) {
+                if ((gen == 2) && (chunk % 2))
+                    continue;
+                uint32_t numBlks = MIN(maxWrBlks, (ncap - slba));
+                writeMem->SetLBATagPattern(lbaDataSize, bare[i], slba, gen,
+                    numBlks);
+                writeTmpl.SetSLBA(slba);
+                writeTmpl.SetNLB(numBlks - 1);  // 0 based value.
+
+                enableLog = false;
+                if ((slba < maxWrBlks) || (slba >= (ncap - maxWrBlks)))
+                    enableLog = true;
+                work = str(boost::format("NSID.%d.SLBA.%ld.gen.%d") %
+                    bare[i] % slba % gen);
+                IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+                    iosq, iocq, writeTmpl, work, enableLog);
+            }
+        }
+
+        LOG_NRM("Reading back and verifying #%ld blks", ncap);
+        uint64_t chunk = 0;
+        for (uint64_t slba = 0; slba < ncap; slba += maxWrBlks, chunk++) {
+            uint32_t numBlks = MIN(maxWrBlks, (ncap - slba));
+            readTmpl.SetSLBA(slba);
+            readTmpl.SetNLB(numBlks - 1);  // 0 based value.
+
+            enableLog = false;
+            if ((slba < maxWrBlks) || (slba >= (ncap - maxWrBlks)))
+                enableLog = true;
+            work = str(boost::format("NSID.%d.SLBA.%ld") % bare[i] % slba);
+            IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+                iosq, iocq, readTmpl, work, enableLog);
+
+            VerifyDataPat(readCmd, lbaDataSize, bare[i], slba, numBlks,
+                ((chunk % 2) ? 1 : 2));
+        }
+    }
+}
+
+
+void
+LBATagSweep_r10b::VerifyDataPat(SharedReadPtr readCmd, uint32_t lbaDataSize,
+    uint32_t nsid, uint64_t slba, uint32_t numBlks, uint32_t gen)
+{
+    LBATagReport report;
+
+    SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
+    if (rdPayload->VerifyLBATagPattern(lbaDataSize, nsid, slba, gen, report,
+        numBlks) == false) {
+        readCmd->Dump(
+            FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
+            "Read command");
+        rdPayload->Dump(
+            FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadPayload"),
+            "Data read from media is stale, misplaced or corrupt");
+        throw FrmwkEx(HERE, "%ld stale, %ld future, %ld misplaced, "
+            "%ld corrupt blks read from SLBA 0x%016lX",
+            report.GetNumBlks(LBATagReport::BLK_STALE),
+            report.GetNumBlks(LBATagReport::BLK_FUTURE),
+            report.GetNumBlks(LBATagReport::BLK_MISPLACED),
+            report.GetNumBlks(LBATagReport::BLK_CORRUPT), slba);
+    }
+}
+
+}   // namespace
@@ -106,7 +106,6 @@ NLBABare_r10b::RunCoreTest()
      */
     string work;
     bool enableLog;
-    ConstSharedIdentifyPtr namSpcPtr;
 
     LOG_NRM("Lookup objs which were created in a prior test within group");
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
@@ -134,13 +133,13 @@ NLBABare_r10b::RunCoreTest()
         DATAPAT_CONST_32BIT
     };
     uint64_t dpArrSize = sizeof(dataPat) / sizeof(dataPat[0]);
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         uint64_t maxWrBlks = (1 << CDW12_NLB_BITS); // 1-based value.
-        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+        uint64_t ncap = nsIdx.ncap[bare[i] - 1];
         maxWrBlks = (maxWrBlks < ncap) ? maxWrBlks : ncap; // limit by ncap.
         if (maxDtXferSz != 0)
             maxWrBlks = MIN(maxWrBlks, (maxDtXferSz / lbaDataSize));
@@ -148,6 +147,16 @@ NLBABare_r10b::RunCoreTest()
         writeCmd->SetNSID(bare[i]);
         readCmd->SetNSID(bare[i]);
 
+        // The buffers are bound once for the largest transfer, thereafter
+        // only the NLB of the cmds is patched for every transfer size.
+        writeMem->InitHugePage(maxWrBlks * lbaDataSize);
+        writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+        CmdTemplate writeTmpl(writeCmd, lbaDataSize);
+
+        readMem->InitHugePage(maxWrBlks * lbaDataSize);
+        readCmd->SetPrpBuffer(prpBitmask, readMem);
+        CmdTemplate readTmpl(readCmd, lbaDataSize);
+
         // If we execute for every possible LBA, then it will take hrs to
         // complete. So incrementing LBA in powers of 2 is a best effort
         // solution to minimize the execution time.
@@ -155,30 +164,29 @@ NLBABare_r10b::RunCoreTest()
         for (uint64_t lbaPow2 = 2; lbaPow2 <= maxWrBlks; lbaPow2 <<= 1) {
             // nLBA = {(1, 2, 3), (3, 4, 5), ..., (0xFFFF, 0x10000, 0x10001)}
             for (uint64_t nLBA = (lbaPow2 - 1); nLBA <= (lbaPow2 + 1); nLBA++) {
-                LOG_NRM("Processing LBA #%ld of %ld", nLBA, maxWrBlks);
                 if (nLBA > maxWrBlks)
                     break;
-                writeMem->Init(nLBA * lbaDataSize);
-                writeCmd->SetPrpBuffer(prpBitmask, writeMem);
-                writeCmd->SetNLB(nLBA - 1); // 0 based value.
-                writeMem->SetDataPattern(dataPat[(nLBA - 1) % dpArrSize], nLBA);
-
-                readMem->Init(nLBA * lbaDataSize);
-                readCmd->SetPrpBuffer(prpBitmask, readMem);
-                readCmd->SetNLB(nLBA - 1); // 0 based value.
+                uint32_t xferSize = (nLBA * lbaDataSize);
+                writeTmpl.SetNLB(nLBA - 1); // 0 based value.
+                writeMem->SetDataPattern(dataPat[(nLBA - 1) % dpArrSize], nLBA,
+                    0, xferSize);
+                readTmpl.SetNLB(nLBA - 1); // 0 based value.
 
                 enableLog = false;
-                if ((nLBA <= 8) || (nLBA >= (maxWrBlks - 8)))
+                if ((nLBA <= 8) || (nLBA >= (maxWrBlks - 8))) {
+                    LOG_NRM("Processing LBA #%ld of %ld", nLBA, maxWrBlks);
                     enableLog = true;
+                }
                 work = str(boost::format("NSID.%d.LBA.%ld") % bare[i] % nLBA);
 
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
-                    iocq, writeCmd, work, enableLog);
+                    iocq, writeTmpl, work, enableLog);
 
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
-                    iocq, readCmd, work, enableLog);
+                    iocq, readTmpl, work, enableLog);
 
-                VerifyDataPat(readCmd, writeMem);
+                VerifyDataPat(readCmd, writeMem,
+                    dataPat[(nLBA - 1) % dpArrSize], nLBA, 0, xferSize);
             }
         }
     }
@@ -188,11 +196,15 @@ NLBABare_r10b::RunCoreTest()
 
 void
 NLBABare_r10b::VerifyDataPat(SharedReadPtr readCmd,
-    SharedMemBufferPtr wrPayload)
+    SharedMemBufferPtr wrPayload, DataPattern dataPat, uint64_t initVal,
+    uint32_t offset, uint32_t length)
 {
-    LOG_NRM("Compare read vs written data to verify");
+    MismatchReport report;
+
+    LOG_NRM("Verify read data against the pattern which was written");
     SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
-    if (rdPayload->Compare(wrPayload) == false) {
+    if (rdPayload->VerifyPattern(dataPat, initVal, offset, length, report)
+        == false) {
         readCmd->Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
             "Read command");
@@ -54,7 +54,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     // Adding a member variable? Then edit the copy constructor and operator=().
     ///////////////////////////////////////////////////////////////////////////
-    void VerifyDataPat(SharedReadPtr readCmd, SharedMemBufferPtr wrPayload);
+    void VerifyDataPat(SharedReadPtr readCmd, SharedMemBufferPtr wrPayload,
+        DataPattern dataPat, uint64_t initVal, uint32_t offset,
+        uint32_t length);
 };
 
 }   // namespace
@@ -108,7 +108,6 @@ NLBAMeta_r10b::RunCoreTest()
     bool enableLog;
     SharedIOSQPtr iosq;
     SharedIOCQPtr iocq;
-    ConstSharedIdentifyPtr namSpcPtr;
     uint64_t metaBuffSz;
 
     if (gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY) == false)
@@ -143,6 +142,7 @@ NLBAMeta_r10b::RunCoreTest()
         DATAPAT_CONST_32BIT
     };
     uint64_t dpArrSize = sizeof(dataPat) / sizeof(dataPat[0]);
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
 
     vector<uint32_t> meta = gInformative->GetMetaNamespaces();
     for (size_t i = 0; i < meta.size(); i++) {
@@ -160,15 +160,13 @@ NLBAMeta_r10b::RunCoreTest()
         LOG_NRM("Create IOSQ and IOCQ with ID #%d", IOQ_ID);
         CreateIOQs(asq, acq, IOQ_ID, iosq, iocq);
 
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(meta[i]);
-        LBAFormat lbaFormat = namSpcPtr->GetLBAFormat();
-        uint64_t lbaDataSize = (1 << lbaFormat.LBADS);
+        uint16_t ms = nsIdx.ms[meta[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[meta[i] - 1];
         uint64_t maxWrBlks = (1 << CDW12_NLB_BITS);     // 1- based value.
-        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+        uint64_t ncap = nsIdx.ncap[meta[i] - 1];
         maxWrBlks = (maxWrBlks < ncap) ? maxWrBlks : ncap; // limit by ncap.
 
-        Informative::NamspcType nsType =
-            gInformative->IdentifyNamespace(namSpcPtr);
+        Informative::NamspcType nsType = nsIdx.type[meta[i] - 1];
         switch (nsType) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
@@ -176,7 +174,7 @@ NLBAMeta_r10b::RunCoreTest()
             LOG_NRM("Process for separate meta buffer");
             if (maxDtXferSz != 0)
                 maxWrBlks = MIN(maxWrBlks, (maxDtXferSz / lbaDataSize));
-            metaBuffSz = maxWrBlks * lbaFormat.MS;
+            metaBuffSz = maxWrBlks * ms;
             if (gRsrcMngr->SetMetaAllocSize(metaBuffSz) == false)
                 throw FrmwkEx(HERE);
             writeCmd->AllocMetaBuffer();
@@ -186,7 +184,7 @@ NLBAMeta_r10b::RunCoreTest()
             LOG_NRM("Process for integrated meta buffer");
             if (maxDtXferSz != 0) {
                 maxWrBlks = MIN(maxWrBlks,
-                    (maxDtXferSz / (lbaDataSize + lbaFormat.MS)));
+                    (maxDtXferSz / (lbaDataSize + ms)));
             }
             break;
         case Informative::NS_E2ES:
@@ -214,15 +212,15 @@ NLBAMeta_r10b::RunCoreTest()
                 case Informative::NS_BARE:
                     throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
                 case Informative::NS_METAS:
-                    writeMem->Init(nLBA * lbaDataSize);
-                    readMem->Init(nLBA * lbaDataSize);
-                    metaBuffSz = nLBA * lbaFormat.MS;
+                    writeMem->InitHugePage(nLBA * lbaDataSize);
+                    readMem->InitHugePage(nLBA * lbaDataSize);
+                    metaBuffSz = nLBA * ms;
                     writeCmd->SetMetaDataPattern
                         (dataPat[(nLBA - 1) % dpArrSize], nLBA);
                     break;
                 case Informative::NS_METAI:
-                    writeMem->Init(nLBA * (lbaDataSize + lbaFormat.MS));
-                    readMem->Init(nLBA * (lbaDataSize + lbaFormat.MS));
+                    writeMem->InitHugePage(nLBA * (lbaDataSize + ms));
+                    readMem->InitHugePage(nLBA * (lbaDataSize + ms));
                     break;
                 case Informative::NS_E2ES:
                 case Informative::NS_E2EI:
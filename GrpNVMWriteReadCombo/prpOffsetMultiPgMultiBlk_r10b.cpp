@@ -203,6 +203,28 @@ PRPOffsetMultiPgMultiBlk_r10b::RunCoreTest()
             break;
         }
         LOG_NRM("Processing at page offset #%ld", pgOff);
+
+        // The buffers are bound once per page offset for the largest xfer,
+        // thereafter only the NLB of the cmds is patched for every xfer size.
+        uint64_t maxBlks = MIN((Y + 1), (maxDtXferSz / lbaDataSize));
+        if (maxBlks == 0) {
+            LOG_WARN("Data xfer sz exceeds max allowed, continuing..");
+            continue;
+        }
+        uint32_t lbaSize = lbaDataSize;
+        if (namspcData.type == Informative::NS_METAI)
+            lbaSize += lbaFormat.MS;
+        writeMem->InitOffset1stPage((maxBlks * lbaSize), pgOff, false);
+        readMem->InitOffset1stPage((maxBlks * lbaSize), pgOff, false);
+        writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+        readCmd->SetPrpBuffer(prpBitmask, readMem);
+        CmdTemplate writeTmpl(writeCmd, lbaSize);
+        CmdTemplate readTmpl(readCmd, lbaSize);
+
+        enableLog = false;
+        if ((pgOff <= 8) || (pgOff >= (X - 8)))
+            enableLog = true;
+
         // lbaPow2 = {2, 4, 8, 16, 32, 64, ...}
         for (uint64_t lbaPow2 = 2; lbaPow2 <= Y; lbaPow2 <<= 1) {
             // nLBA = {(1, 2, 3), (3, 4, 5), (7, 8, 9), (15, 16, 17), ...}
@@ -224,47 +246,22 @@ PRPOffsetMultiPgMultiBlk_r10b::RunCoreTest()
                 }
 
                 uint64_t metabufSz = nLBA * lbaFormat.MS;
-                switch (namspcData.type) {
-                case Informative::NS_BARE:
-                    writeMem->InitOffset1stPage(dtPayloadSz, pgOff, false);
-                    readMem->InitOffset1stPage(dtPayloadSz, pgOff, false);
-                    break;
-                case Informative::NS_METAS:
-                    writeMem->InitOffset1stPage(dtPayloadSz, pgOff, false);
-                    readMem->InitOffset1stPage(dtPayloadSz, pgOff, false);
+                uint32_t xferSz = (nLBA * lbaSize);
+                if (namspcData.type == Informative::NS_METAS)
                     writeCmd->SetMetaDataPattern(dataPat, wrVal, 0, metabufSz);
-                    break;
-                case Informative::NS_METAI:
-                    writeMem->InitOffset1stPage(
-                        (dtPayloadSz + metabufSz), pgOff, false);
-                    readMem->InitOffset1stPage(
-                        (dtPayloadSz + metabufSz), pgOff, false);
-                    break;
-                case Informative::NS_E2ES:
-                case Informative::NS_E2EI:
-                    throw FrmwkEx(HERE,
-                        "Deferring work to handle this case in future");
-                    break;
-                }
                 work = str(boost::format("pgOff.%d.nlba.%d") % pgOff % nLBA);
-                writeCmd->SetPrpBuffer(prpBitmask, writeMem);
-                writeMem->SetDataPattern(dataPat, wrVal);
-                writeCmd->SetNLB(nLBA - 1); // convert to 0 based.
-
-                enableLog = false;
-                if ((pgOff <= 8) || (pgOff >= (X - 8)))
-                    enableLog = true;
+                writeMem->SetDataPattern(dataPat, wrVal, 0, xferSz);
+                writeTmpl.SetNLB(nLBA - 1); // convert to 0 based.
 
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
-                    iocq, writeCmd, work, enableLog);
+                    iocq, writeTmpl, work, enableLog);
 
-                readCmd->SetPrpBuffer(prpBitmask, readMem);
-                readCmd->SetNLB(nLBA - 1); // convert to 0 based.
+                readTmpl.SetNLB(nLBA - 1); // convert to 0 based.
 
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
-                    iocq, readCmd, work, enableLog);
+                    iocq, readTmpl, work, enableLog);
 
-                VerifyDataPat(readCmd, dataPat, wrVal, metabufSz);
+                VerifyDataPat(readCmd, dataPat, wrVal, xferSz, metabufSz);
             }
         }
     }
@@ -311,15 +308,16 @@ PRPOffsetMultiPgMultiBlk_r10b::InitTstRsrcs(SharedASQPtr asq, SharedACQPtr acq,
 
 void
 PRPOffsetMultiPgMultiBlk_r10b::VerifyDataPat(SharedReadPtr readCmd,
-    DataPattern dataPat, uint64_t wrVal, uint64_t metabufSz)
+    DataPattern dataPat, uint64_t wrVal, uint32_t xferSz, uint64_t metabufSz)
 {
-    LOG_NRM("Compare read vs written data to verify");
-    SharedMemBufferPtr wrPayload = SharedMemBufferPtr(new MemBuffer());
-    wrPayload->Init(readCmd->GetPrpBufferSize());
-    wrPayload->SetDataPattern(dataPat, wrVal);
+    MismatchReport report;
 
+    // Only the 1st xferSz bytes of the buffer were read into
     SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
-    if (rdPayload->Compare(wrPayload) == false) {
+    if (rdPayload->VerifyPattern(dataPat, wrVal, 0, xferSz, report) == false) {
+        SharedMemBufferPtr wrPayload = SharedMemBufferPtr(new MemBuffer());
+        wrPayload->Init(xferSz);
+        wrPayload->SetDataPattern(dataPat, wrVal);
         readCmd->Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
             "Read command");
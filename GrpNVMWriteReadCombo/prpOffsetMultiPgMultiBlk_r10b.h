@@ -65,7 +65,7 @@ private:
     void InitTstRsrcs(SharedASQPtr asq, SharedACQPtr acq, SharedIOSQPtr &iosq,
         SharedIOCQPtr &iocq);
     void VerifyDataPat(SharedReadPtr readCmd, DataPattern dataPat,
-        uint64_t wrVal, uint64_t metabufSz);
+        uint64_t wrVal, uint32_t xferSz, uint64_t metabufSz);
 };
 
 }   // namespace
@@ -22,6 +22,7 @@
 #include "../Queues/iosq.h"
 #include "../Cmds/write.h"
 #include "../Utils/io.h"
+#include "../Utils/patternGen.h"
 
 
 namespace GrpNVMWriteReadCombo {
@@ -102,7 +103,6 @@ StartingLBABare_r10b::RunCoreTest()
      */
     string work;
     bool enableLog;
-    ConstSharedIdentifyPtr namSpcPtr;
 
     // Lookup objs which were created in a prior test within group
     SharedIOSQPtr iosq = CAST_TO_IOSQ(gRsrcMngr->GetObj(IOSQ_GROUP_ID));
@@ -133,12 +133,12 @@ StartingLBABare_r10b::RunCoreTest()
     uint64_t dpArrSize = sizeof(dataPat) / sizeof(dataPat[0]);
 
     LOG_NRM("Seeking all bare namspc's.");
+    const Informative::NamspcIndex &nsIdx = gInformative->GetNamspcIndex();
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
         LOG_NRM("Processing for BARE name space id #%d", bare[i]);
-        namSpcPtr = gInformative->GetIdentifyCmdNamspc(bare[i]);
-        uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
-        uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+        uint64_t ncap = nsIdx.ncap[bare[i] - 1];
+        uint64_t lbaDataSize = nsIdx.lbaDataSize[bare[i] - 1];
         uint64_t maxWrBlks = maxDtXferSz / lbaDataSize;
 
         writeMem->Init(maxWrBlks * lbaDataSize);
@@ -171,7 +171,8 @@ StartingLBABare_r10b::RunCoreTest()
             IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
                 iocq, readCmd, work, enableLog);
 
-            VerifyDataPat(readCmd, writeMem);
+            VerifyDataPat(readCmd, writeMem, dataPat, dpArrSize, nWrBlks,
+                maxWrBlks, lbaDataSize);
         }
     }
 }
@@ -179,11 +180,22 @@ StartingLBABare_r10b::RunCoreTest()
 
 void
 StartingLBABare_r10b::VerifyDataPat(SharedReadPtr readCmd,
-    SharedMemBufferPtr wrPayload)
+    SharedMemBufferPtr wrPayload, const DataPattern *dataPat,
+    uint64_t dpArrSize, uint64_t sLBA, uint64_t numBlks, uint64_t lbaDataSize)
 {
-    LOG_NRM("Compare read vs written data to verify");
+    MismatchReport report;
+    bool match = true;
+
+    LOG_NRM("Verify read data against the patterns which were written");
     SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
-    if (rdPayload->Compare(wrPayload) == false) {
+    // Each blk holds its own pattern; verify them all w/o logging per blk
+    for (uint64_t nLBA = 0; (nLBA < numBlks) && match; nLBA++) {
+        uint32_t offset = (nLBA * lbaDataSize);
+        match = PatternGen::Verify(dataPat[nLBA % dpArrSize], (sLBA + nLBA + 1),
+            (rdPayload->GetBuffer() + offset), lbaDataSize, report, offset);
+    }
+    if (match == false) {
+        report.Log();
         readCmd->Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
             "Read command");
@@ -54,7 +54,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     // Adding a member variable? Then edit the copy constructor and operator=().
     ///////////////////////////////////////////////////////////////////////////
-    void VerifyDataPat(SharedReadPtr readCmd, SharedMemBufferPtr wrPayload);
+    void VerifyDataPat(SharedReadPtr readCmd, SharedMemBufferPtr wrPayload,
+        const DataPattern *dataPat, uint64_t dpArrSize, uint64_t sLBA,
+        uint64_t numBlks, uint64_t lbaDataSize);
 };
 
 }   // namespace
@@ -62,7 +62,7 @@ private:
     void CreateIOQs(SharedASQPtr asq, SharedACQPtr acq, uint32_t ioqId,
        SharedIOSQPtr &iosq, SharedIOCQPtr &iocq);
     void ResizeDataBuf(SharedReadPtr &readCmd, SharedWritePtr &writeCmd,
-        ConstSharedIdentifyPtr namSpcPtr, uint64_t maxWrBlks,
+        uint32_t nsid, uint64_t maxWrBlks,
         send_64b_bitmask prpBitmask);
 };
 
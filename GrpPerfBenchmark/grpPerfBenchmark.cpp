@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "grpPerfBenchmark.h"
+#include "createResources_r10b.h"
+#include "seqWrite_r10b.h"
+#include "seqRead_r10b.h"
+#include "randRead_r10b.h"
+#include "randWrite_r10b.h"
+#include "randMix_r10b.h"
+
+namespace GrpPerfBenchmark {
+
+
+GrpPerfBenchmark::GrpPerfBenchmark(size_t grpNum) :
+    Group(grpNum, "GrpPerfBenchmark", "Sustained load performance benchmarks.")
+{
+    // For complete details about the APPEND_TEST_AT_?LEVEL() macros:
+    // "https://github.com/nvmecompliance/tnvme/wiki/Test-Numbering" and
+    // "https://github.com/nvmecompliance/tnvme/wiki/Test-Strategy
+    switch (gCmdLine.rev) {
+    case SPECREV_10b:
+        APPEND_TEST_AT_XLEVEL(CreateResources_r10b, GrpPerfBenchmark)
+        APPEND_TEST_AT_YLEVEL(SeqWrite_r10b, GrpPerfBenchmark)
+        APPEND_TEST_AT_YLEVEL(SeqRead_r10b, GrpPerfBenchmark)
+        APPEND_TEST_AT_YLEVEL(RandRead_r10b, GrpPerfBenchmark)
+        APPEND_TEST_AT_YLEVEL(RandWrite_r10b, GrpPerfBenchmark)
+        APPEND_TEST_AT_YLEVEL(RandMix_r10b, GrpPerfBenchmark)
+
+        break;
+
+    default:
+    case SPECREVTYPE_FENCE:
+        throw FrmwkEx(HERE, "Object created with an unknown SpecRev=%d",
+            gCmdLine.rev);
+    }
+}
+
+
+GrpPerfBenchmark::~GrpPerfBenchmark()
+{
+    // mTests deallocated in parent
+}
+
+}   // namespace
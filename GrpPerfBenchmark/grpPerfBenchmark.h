@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _GRPPERFBENCHMARK_H_
+#define _GRPPERFBENCHMARK_H_
+
+#include "../group.h"
+#include "../Exception/frmwkEx.h"
+
+
+namespace GrpPerfBenchmark {
+
+
+/**
+* This class implements sustained load workloads which measure the DUT's
+* performance rather than its compliance. The workloads are parameterized by
+* cmd line option --perf, results are appended to PERF_RESULTS_FILE.
+*/
+class GrpPerfBenchmark : public Group
+{
+public:
+    GrpPerfBenchmark(size_t grpNum);
+    virtual ~GrpPerfBenchmark();
+};
+
+}   // namespace
+
+#endif
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <time.h>
+#include <stdlib.h>
+#include <boost/format.hpp>
+#include "perfWorkload.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Queues/iocq.h"
+#include "../Queues/iosq.h"
+#include "../Cmds/read.h"
+#include "../Cmds/write.h"
+#include "../Cmds/cmdTemplate.h"
+#include "../Utils/io.h"
+#include "../Utils/ioEngine.h"
+#include "../Utils/queues.h"
+#include "../Utils/histogram.h"
+#include "../Utils/cmdLatency.h"
+
+namespace GrpPerfBenchmark {
+
+
+/**
+* Supplies the read/write cmds of a workload to a single IOQ pair. A private
+* pool of cmd templates, each with its own data buffer, is created up front so
+* nothing is allocated nor logged while the workload is sustained. Every cmd's
+* completion latency, measured from being handed out until its CE was reaped,
+* is recorded.
+*/
+class PerfGenerator : public CmdGenerator
+{
+public:
+    /**
+     * @param cfg Pass the access pattern of the workload
+     * @param namspcData Pass the namspc to target
+     * @param numBlks Pass the number of logical blks per cmd (1-based)
+     * @param qDepth Pass the max number of cmds which will be outstanding
+     * @param firstLBA Pass the 1st LBA of the range to target
+     * @param endLBA Pass the LBA just beyond the range to target
+     * @param seed Pass the seed for choosing random LBA's and cmds
+     */
+    PerfGenerator(WorkloadCfg cfg, Informative::Namspc namspcData,
+        uint32_t numBlks, uint32_t qDepth, uint64_t firstLBA, uint64_t endLBA,
+        unsigned int seed);
+    virtual ~PerfGenerator() {}
+
+    virtual bool Next(SharedCmdPtr &cmd);
+    virtual bool NextTemplate(SharedCmdPtr &cmd, CmdTemplate *&tmpl);
+    virtual void Completed(SharedCmdPtr cmd, CmdTemplate *tmpl,
+        const union CE &ce);
+
+    const Histogram &GetLatency() const { return mLatency; }
+    uint64_t GetNumReads() const { return mNumReads; }
+    uint64_t GetNumWrites() const { return mNumWrites; }
+
+
+private:
+    struct Slot {
+        SharedCmdTemplatePtr tmpl;
+        bool isRead;
+        uint64_t submitNs;
+    };
+
+    WorkloadCfg mCfg;
+    uint32_t mNumBlks;
+    uint64_t mFirstLBA;
+    uint64_t mNumChunks;
+    uint64_t mNextLBA;
+    unsigned int mSeed;
+    uint64_t mDeadlineNs;
+
+    vector<Slot> mSlots;
+    vector<uint32_t> mFreeReads;
+    vector<uint32_t> mFreeWrites;
+
+    Histogram mLatency;
+    uint64_t mNumReads;
+    uint64_t mNumWrites;
+
+    SharedMemBufferPtr AllocDataBuf(Informative::Namspc &namspcData);
+};
+
+
+PerfGenerator::PerfGenerator(WorkloadCfg cfg, Informative::Namspc namspcData,
+    uint32_t numBlks, uint32_t qDepth, uint64_t firstLBA, uint64_t endLBA,
+    unsigned int seed)
+{
+    mCfg = cfg;
+    mNumBlks = numBlks;
+    mFirstLBA = firstLBA;
+    mNumChunks = ((endLBA - firstLBA) / numBlks);
+    mNextLBA = firstLBA;
+    mSeed = seed;
+    mDeadlineNs = 0;
+    mNumReads = 0;
+    mNumWrites = 0;
+
+    if (mNumChunks == 0) {
+        throw FrmwkEx(HERE, "LBA range 0x%llX - 0x%llX cannot fit %d blks",
+            (unsigned long long)firstLBA, (unsigned long long)endLBA, numBlks);
+    }
+
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)(MASK_PRP1_PAGE
+        | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    for (uint32_t i = 0; i < qDepth; i++) {
+        if (mCfg.readPct != 0) {
+            Slot slot;
+            SharedReadPtr read = SharedReadPtr(new Read());
+            read->SetPrpBuffer(prpBitmask, AllocDataBuf(namspcData));
+            if (namspcData.type == Informative::NS_METAS)
+                read->AllocMetaBuffer();
+            read->SetNSID(namspcData.id);
+            read->SetNLB(numBlks - 1);     // 0 based value
+            slot.tmpl = SharedCmdTemplatePtr(new CmdTemplate(read));
+            slot.tmpl->SetTag(mSlots.size());
+            slot.isRead = true;
+            mFreeReads.push_back(mSlots.size());
+            mSlots.push_back(slot);
+        }
+        if (mCfg.readPct != 100) {
+            Slot slot;
+            SharedMemBufferPtr dataBuf = AllocDataBuf(namspcData);
+            dataBuf->SetDataPattern(DATAPAT_INC_32BIT, i);
+            SharedWritePtr write = SharedWritePtr(new Write());
+            write->SetPrpBuffer(prpBitmask, dataBuf);
+            if (namspcData.type == Informative::NS_METAS) {
+                write->AllocMetaBuffer();
+                write->SetMetaDataPattern(DATAPAT_INC_32BIT, i);
+            }
+            write->SetNSID(namspcData.id);
+            write->SetNLB(numBlks - 1);    // 0 based value
+            slot.tmpl = SharedCmdTemplatePtr(new CmdTemplate(write));
+            slot.tmpl->SetTag(mSlots.size());
+            slot.isRead = false;
+            mFreeWrites.push_back(mSlots.size());
+            mSlots.push_back(slot);
+        }
+    }
+}
+
+
+SharedMemBufferPtr
+PerfGenerator::AllocDataBuf(Informative::Namspc &namspcData)
+{
+    LBAFormat lbaFormat = namspcData.idCmdNamspc->GetLBAFormat();
+    uint64_t lbaDataSize = namspcData.idCmdNamspc->GetLBADataSize();
+    SharedMemBufferPtr dataBuf = SharedMemBufferPtr(new MemBuffer());
+
+    switch (namspcData.type) {
+    case Informative::NS_BARE:
+    case Informative::NS_METAS:
+        dataBuf->InitHugePage(mNumBlks * lbaDataSize);
+        break;
+    case Informative::NS_METAI:
+        dataBuf->InitHugePage(mNumBlks * (lbaDataSize + lbaFormat.MS));
+        break;
+    case Informative::NS_E2ES:
+    case Informative::NS_E2EI:
+        throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+        break;
+    }
+    return dataBuf;
+}
+
+
+bool
+PerfGenerator::Next(SharedCmdPtr &cmd)
+{
+    CmdTemplate *tmpl;
+    return NextTemplate(cmd, tmpl);
+}
+
+
+bool
+PerfGenerator::NextTemplate(SharedCmdPtr &cmd, CmdTemplate *&tmpl)
+{
+    uint64_t now = CmdLatency::Now();
+
+    // The workload's duration commences when the 1st cmd is requested
+    if (mDeadlineNs == 0)
+        mDeadlineNs = (now + ((uint64_t)gCmdLine.perf.seconds * 1000000000ULL));
+    else if (now >= mDeadlineNs)
+        return false;
+
+    bool isRead = (mCfg.readPct == 100);
+    if ((mCfg.readPct != 0) && (mCfg.readPct != 100))
+        isRead = ((uint32_t)(rand_r(&mSeed) % 100) < mCfg.readPct);
+
+    vector<uint32_t> &freeSlots = (isRead ? mFreeReads : mFreeWrites);
+    if (freeSlots.empty())
+        throw FrmwkEx(HERE, "More cmds outstanding than were allocated");
+    Slot &slot = mSlots[freeSlots.back()];
+    freeSlots.pop_back();
+
+    uint64_t lba;
+    if (mCfg.random) {
+        uint64_t rnd = (((uint64_t)rand_r(&mSeed) << 31) | rand_r(&mSeed));
+        lba = (mFirstLBA + ((rnd % mNumChunks) * mNumBlks));
+    } else {
+        lba = mNextLBA;
+        mNextLBA += mNumBlks;
+        if (mNextLBA >= (mFirstLBA + (mNumChunks * mNumBlks)))
+            mNextLBA = mFirstLBA;
+    }
+
+    slot.tmpl->SetSLBA(lba);
+    slot.submitNs = CmdLatency::Now();
+    tmpl = slot.tmpl.get();
+    cmd = tmpl->GetCmd();
+    return true;
+}
+
+
+void
+PerfGenerator::Completed(SharedCmdPtr cmd, CmdTemplate *tmpl,
+    const union CE &ce)
+{
+    (void)ce;
+    uint64_t now = CmdLatency::Now();
+
+    // The template's tag is the index of its slot, see PerfGenerator()
+    uint32_t idx = ((tmpl == NULL) ? mSlots.size() : tmpl->GetTag());
+    if ((idx >= mSlots.size()) || (mSlots[idx].tmpl->GetCmd() != cmd))
+        throw FrmwkEx(HERE, "Completed cmd was not issued by this workload");
+
+    Slot &slot = mSlots[idx];
+    mLatency.Record(now - slot.submitNs);
+    if (slot.isRead) {
+        mNumReads++;
+        mFreeReads.push_back(idx);
+    } else {
+        mNumWrites++;
+        mFreeWrites.push_back(idx);
+    }
+}
+
+
+/**
+ * Append the results of a workload to the CSV results file, writing a header
+ * line when the file is 1st created.
+ */
+static void
+AppendResults(string testName, WorkloadCfg cfg, uint64_t blkBytes,
+    uint32_t qDepth, uint32_t numQPairs, double seconds, uint64_t numCmds,
+    double iops, double mbps, const Histogram &latency)
+{
+    FILE *fp;
+    string filename = gCmdLine.dump + "/" + PERF_RESULTS_FILE;
+
+    // The firmware revision is 8 ASCII chars padded with spaces
+    char fr[9];
+    uint64_t frVal =
+        gInformative->GetIdentifyCmdCtrlr()->GetValue(IDCTRLRCAP_FR);
+    for (size_t i = 0; i < 8; i++)
+        fr[i] = (char)(frVal >> (i * 8));
+    fr[8] = '\0';
+    for (int i = 7; (i >= 0) && ((fr[i] == ' ') || (fr[i] == '\0')); i--)
+        fr[i] = '\0';
+
+    bool exists = (access(filename.c_str(), F_OK) == 0);
+    if ((fp = fopen(filename.c_str(), "a")) == NULL)
+        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+
+    if (exists == false) {
+        fprintf(fp, "epoch,fw,test,pattern,read_pct,blk_bytes,qdepth,qpairs,"
+            "seconds,cmds,iops,mbps,lat_p50_us,lat_p99_us,lat_p99.9_us,"
+            "lat_max_us\n");
+    }
+    fprintf(fp, "%ld,%s,%s,%s,%d,%llu,%d,%d,%.3f,%llu,%.1f,%.3f,%.3f,%.3f,"
+        "%.3f,%.3f\n", (long)time(NULL), fr, testName.c_str(),
+        cfg.random ? "random" : "sequential", cfg.readPct,
+        (unsigned long long)blkBytes, qDepth, numQPairs, seconds,
+        (unsigned long long)numCmds, iops, mbps,
+        (latency.GetPercentile(50.0) / 1000.0),
+        (latency.GetPercentile(99.0) / 1000.0),
+        (latency.GetPercentile(99.9) / 1000.0),
+        (latency.GetMax() / 1000.0));
+    fclose(fp);
+}
+
+
+/// Delete from the DUT every IOQ pair of a workload
+static void
+DeleteIOQPairs(string grpName, string testName, SharedASQPtr asq,
+    SharedACQPtr acq, vector<SharedIOSQPtr> &iosqs,
+    vector<SharedIOCQPtr> &iocqs)
+{
+    for (size_t i = 0; i < iosqs.size(); i++) {
+        Queues::DeleteIOSQToHdw(grpName, testName, CALC_TIMEOUT_ms(1),
+            iosqs[i], asq, acq, "", false);
+    }
+    for (size_t i = 0; i < iocqs.size(); i++) {
+        Queues::DeleteIOCQToHdw(grpName, testName, CALC_TIMEOUT_ms(1),
+            iocqs[i], asq, acq, "", false);
+    }
+}
+
+
+void
+PerfWorkload::Run(string grpName, string testName, WorkloadCfg cfg)
+{
+    uint64_t maxIOQEntries;
+
+    // Lookup objs which were created in a prior test within group
+    SharedASQPtr asq = CAST_TO_ASQ(gRsrcMngr->GetObj(ASQ_GROUP_ID))
+    SharedACQPtr acq = CAST_TO_ACQ(gRsrcMngr->GetObj(ACQ_GROUP_ID))
+
+    // -x(--perf) may override every test's own access pattern
+    if (gCmdLine.perf.readPct >= 0)
+        cfg.readPct = (uint8_t)gCmdLine.perf.readPct;
+    if (gCmdLine.perf.pattern != PERFPAT_TEST)
+        cfg.random = (gCmdLine.perf.pattern == PERFPAT_RAND);
+
+    Informative::Namspc namspcData = gInformative->Get1stBareMetaE2E();
+    LBAFormat lbaFormat = namspcData.idCmdNamspc->GetLBAFormat();
+    uint64_t lbaDataSize = namspcData.idCmdNamspc->GetLBADataSize();
+    uint64_t ncap = namspcData.idCmdNamspc->GetValue(IDNAMESPC_NCAP);
+    LOG_NRM("Processing workload using namspc id %d", namspcData.id);
+
+    // Fit the workload to what the DUT supports
+    uint32_t maxDtXferSz = gInformative->GetIdentifyCmdCtrlr()->
+        GetMaxDataXferSize();
+    if (maxDtXferSz == 0)
+        maxDtXferSz = MAX_DATA_TX_SIZE;
+    uint32_t numBlks = MIN(gCmdLine.perf.numBlks, (maxDtXferSz / lbaDataSize));
+    if (numBlks == 0)
+        throw FrmwkEx(HERE, "Max data xfer size cannot hold a single blk");
+
+    uint32_t numQPairs = MIN(gCmdLine.perf.numQPairs,
+        MIN(gInformative->GetFeaturesNumOfIOSQs(),
+        gInformative->GetFeaturesNumOfIOCQs()));
+
+    if (gRegisters->Read(CTLSPC_CAP, maxIOQEntries) == false)
+        throw FrmwkEx(HERE, "Unable to determine MQES");
+    maxIOQEntries = ((maxIOQEntries & CAP_MQES) + 1);    // convert to 1-based
+    uint32_t numEntries = MIN((gCmdLine.perf.qDepth + 1), maxIOQEntries);
+    uint32_t qDepth = (numEntries - 1);
+
+    if (namspcData.type == Informative::NS_METAS) {
+        if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS * numBlks) == false)
+            throw FrmwkEx(HERE);
+    }
+
+    LOG_NRM("Workload: %s, %d%% reads, %d blks/cmd, QD %d, %d IOQ pairs, %d s",
+        cfg.random ? "random" : "sequential", cfg.readPct, numBlks, qDepth,
+        numQPairs, gCmdLine.perf.seconds);
+
+    vector<SharedIOSQPtr> iosqs;
+    vector<SharedIOCQPtr> iocqs;
+    vector<boost::shared_ptr<PerfGenerator> > gens;
+    IOEngine engine(grpName, testName);
+    uint64_t startNs = 0;
+    try {
+        for (uint16_t ioqId = 1; ioqId <= numQPairs; ioqId++) {
+            iocqs.push_back(Queues::CreateIOCQContigToHdw(grpName, testName,
+                CALC_TIMEOUT_ms(1), asq, acq, ioqId, numEntries, false,
+                IOCQ_GROUP_ID, false, 0, "", false));
+            iosqs.push_back(Queues::CreateIOSQContigToHdw(grpName, testName,
+                CALC_TIMEOUT_ms(1), asq, acq, ioqId, numEntries, false,
+                IOSQ_GROUP_ID, ioqId, 0, "", false));
+
+            // Sequential workloads split the namspc into a region per IOQ pair
+            uint64_t firstLBA = 0;
+            uint64_t endLBA = ncap;
+            if (cfg.random == false) {
+                firstLBA = ((ncap / numQPairs) * (ioqId - 1));
+                endLBA = (firstLBA + (ncap / numQPairs));
+            }
+            gens.push_back(boost::shared_ptr<PerfGenerator>(new PerfGenerator(
+                cfg, namspcData, numBlks, qDepth, firstLBA, endLBA, ioqId)));
+            engine.AddWorker(iosqs.back(), iocqs.back(), *gens.back(), qDepth,
+                CALC_TIMEOUT_ms(qDepth));
+        }
+
+        startNs = CmdLatency::Now();
+        engine.Run();
+    } catch (...) {
+        // Don't leave IOQ pairs behind on the DUT, nor mask the failure
+        try {
+            DeleteIOQPairs(grpName, testName, asq, acq, iosqs, iocqs);
+        } catch (...) {
+            LOG_ERR("Unable to delete the IOQ pairs of the failed workload");
+        }
+        throw;
+    }
+    double seconds = ((CmdLatency::Now() - startNs) / 1000000000.0);
+
+    Histogram latency;
+    uint64_t numReads = 0;
+    uint64_t numWrites = 0;
+    for (size_t i = 0; i < gens.size(); i++) {
+        latency.Merge(gens[i]->GetLatency());
+        numReads += gens[i]->GetNumReads();
+        numWrites += gens[i]->GetNumWrites();
+    }
+
+    uint64_t numCmds = (numReads + numWrites);
+    uint64_t blkBytes = (numBlks * lbaDataSize);
+    double iops = (numCmds / seconds);
+    double mbps = ((numCmds * blkBytes) / seconds / 1000000.0);
+    LOG_NRM("Completed %llu reads, %llu writes in %.3f s",
+        (unsigned long long)numReads, (unsigned long long)numWrites, seconds);
+    LOG_NRM("IOPS = %.1f, MB/s = %.3f", iops, mbps);
+    latency.Log("Completion latency", "ns");
+    AppendResults(testName, cfg, blkBytes, qDepth, numQPairs, seconds,
+        numCmds, iops, mbps, latency);
+
+    DeleteIOQPairs(grpName, testName, asq, acq, iosqs, iocqs);
+}
+
+}   // namespace
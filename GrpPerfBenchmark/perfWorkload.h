@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _PERFWORKLOAD_H_
+#define _PERFWORKLOAD_H_
+
+#include "tnvme.h"
+
+namespace GrpPerfBenchmark {
+
+
+/// Describes the access pattern of a workload, the remainder of the workload
+/// is described by gCmdLine.perf
+struct WorkloadCfg {
+    bool        random;     // random LBA's, otherwise sequential LBA's
+    uint8_t     readPct;    // [0 - 100] percentage of cmds which are reads
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It performs the work common to all tests within
+* GrpPerfBenchmark; sustaining a workload against the 1st bare, meta, or E2E
+* namspc across gCmdLine.perf.numQPairs IOQ pairs and reporting the outcome.
+*
+* @note This class may throw exceptions.
+*/
+class PerfWorkload
+{
+public:
+    /**
+     * Create the IOQ pairs, sustain the workload for gCmdLine.perf.seconds,
+     * then delete the IOQ pairs. IOPS, MB/s, and completion latency
+     * percentiles are logged and appended as a single line to the CSV file
+     * PERF_RESULTS_FILE within the root dump directory. The IOQ pairs are
+     * deleted even when the workload fails.
+     * @note Requires test CreateResources_r10b to have run prior.
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param cfg Pass the test's own access pattern, gCmdLine.perf.readPct
+     *      and gCmdLine.perf.pattern override it when specified.
+     */
+    static void Run(string grpName, string testName, WorkloadCfg cfg);
+
+
+private:
+    PerfWorkload();
+    virtual ~PerfWorkload();
+};
+
+}   // namespace
+
+#endif
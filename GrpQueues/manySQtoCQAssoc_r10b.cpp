@@ -127,6 +127,9 @@ ManySQtoCQAssoc_r10b::RunCoreTest()
     vector<uint32_t> mSQIDToSQHDVector;
     mSQIDToSQHDVector.push_back(USHRT_MAX); // vector position 0 is not used.
 
+    // CE's from all IOSQs are matched back to their cmd by (SQID, CID)
+    CEDispatcher dispatcher(mGrpName, mTestName, iocq);
+
     LOG_NRM("Create Maximum allowed IOSQs and associate with same IOCQ.");
     for (uint32_t j = 1; j <= gInformative->GetFeaturesNumOfIOSQs(); j++) {
         LOG_NRM("Creating contig IOSQ #%d", j);
@@ -137,15 +140,17 @@ ManySQtoCQAssoc_r10b::RunCoreTest()
         iosqVector.push_back(iosq);
         mSQIDToSQHDVector.push_back(0);
 
-        for (vector <SharedIOSQPtr>::iterator iosq = iosqVector.begin();
-            iosq != iosqVector.end(); iosq++) {
-            (*iosq)->Send(writeCmd, uniqueId);
-            (*iosq)->Ring();
-            mSQIDToSQHDVector[(*iosq)->GetQId()] =
-                ++mSQIDToSQHDVector[(*iosq)->GetQId()] %
-                (*iosq)->GetNumEntries();
+        vector<CEFuture> futures(iosqVector.size());
+        for (size_t k = 0; k < iosqVector.size(); k++) {
+            iosqVector[k]->Send(writeCmd, uniqueId);
+            iosqVector[k]->Ring();
+            dispatcher.Register(iosqVector[k]->GetQId(), uniqueId,
+                &futures[k]);
+            mSQIDToSQHDVector[iosqVector[k]->GetQId()] =
+                ++mSQIDToSQHDVector[iosqVector[k]->GetQId()] %
+                iosqVector[k]->GetNumEntries();
         }
-        ReapIOCQAndVerifyCE(iocq, j, mSQIDToSQHDVector);
+        ReapIOCQAndVerifyCE(iocq, dispatcher, futures, mSQIDToSQHDVector);
     }
 
     LOG_NRM("Delete all IOSQs before the IOCQ to comply with spec.");
@@ -202,43 +207,19 @@ ManySQtoCQAssoc_r10b::SetWriteCmd()
 
 
 void
-ManySQtoCQAssoc_r10b::ReapIOCQAndVerifyCE(SharedIOCQPtr iocq, uint32_t numTil,
+ManySQtoCQAssoc_r10b::ReapIOCQAndVerifyCE(SharedIOCQPtr iocq,
+    CEDispatcher &dispatcher, vector<CEFuture> &futures,
     vector<uint32_t> mSQIDToSQHDVector)
 {
-    uint32_t numCE;
-    uint32_t ceRemain;
-    uint32_t numReaped;
-    uint32_t isrCount;
-
-    LOG_NRM("Reap one CE and verify and do for all the CE's in CQ.");
-    for (uint32_t i = 0; i < numTil; i++) {
-        LOG_NRM("Wait for the CE to arrive in IOCQ");
-        if (iocq->ReapInquiryWaitSpecify(CALC_TIMEOUT_ms(1), 1, numCE,
-            isrCount) == false) {
-
-            iocq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "missing"),
-                "Unable to see completion of cmd");
-            throw FrmwkEx(HERE);
-        } else if (numCE == 0) {
-            iocq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "missing"),
-                "Unable to see completion of cmd");
-            throw FrmwkEx(HERE, "IOCQ should have one new CE for each IOSQ");
-        }
-
-        LOG_NRM("The CQ's metrics before reaping holds head_ptr");
-        struct nvme_gen_cq iocqMetrics = iocq->GetQMetrics();
-        KernelAPI::LogCQMetrics(iocqMetrics);
-
-        LOG_NRM("Reaping CE from IOCQ, requires memory to hold reaped CE");
-        SharedMemBufferPtr ceMemIOCQ = SharedMemBufferPtr(new MemBuffer());
-        if ((numReaped = iocq->Reap(ceRemain, ceMemIOCQ, isrCount, 1, true))
-            != 1) {
-
-            throw FrmwkEx(HERE, "Requested to reap 1 CE, but reaping produced %d",
-                numReaped);
-        }
+    LOG_NRM("Reap and dispatch all the CE's in CQ to their cmds.");
+    if (dispatcher.DispatchAll(CALC_TIMEOUT_ms(1)) == false) {
+        iocq->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "missing"),
+            "Unable to see completion of cmd");
+        throw FrmwkEx(HERE, "IOCQ should have one new CE for each IOSQ");
+    }
 
-        union CE ce = iocq->PeekCE(iocqMetrics.head_ptr);
+    for (size_t i = 0; i < futures.size(); i++) {
+        union CE ce = futures[i].GetCE();
         ProcessCE::Validate(ce, CESTAT_SUCCESS);  // throws upon error
 
         LOG_NRM("Validate CE of IOSQ ID=%d", ce.n.SQID);
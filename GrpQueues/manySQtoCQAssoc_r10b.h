@@ -26,6 +26,7 @@
 #include "../Queues/iosq.h"
 #include "../Cmds/write.h"
 #include "../Utils/queues.h"
+#include "../Utils/ceDispatcher.h"
 
 namespace GrpQueues {
 
@@ -62,8 +63,8 @@ private:
     // Adding a member variable? Then edit the copy constructor and operator=().
     ///////////////////////////////////////////////////////////////////////////
     SharedWritePtr SetWriteCmd();
-    void ReapIOCQAndVerifyCE(SharedIOCQPtr iocq, uint32_t numTil,
-        vector<uint32_t> mSQIDToSQHDVector);
+    void ReapIOCQAndVerifyCE(SharedIOCQPtr iocq, CEDispatcher &dispatcher,
+        vector<CEFuture> &futures, vector<uint32_t> mSQIDToSQHDVector);
 };
 
 }   // namespace
@@ -14,14 +14,23 @@
  *  limitations under the License.
  */
 
-#include <sys/time.h>
+#include <time.h>
+#include <string.h>
 #include "cq.h"
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/buffers.h"
+#include "../Utils/cmdLatency.h"
+#include "../Utils/traceLog.h"
+#include "../Utils/deferredDump.h"
 
 SharedCQPtr CQ::NullCQPtr;
 
+/// Adaptive waiting spins w/o sleeping for this many us before backing off
+#define CQWAIT_SPIN_US              20
+/// Adaptive waiting doubles the sleep period up to this many us
+#define CQWAIT_MAX_BACKOFF_US       64
+
 
 CQ::CQ() : Queue(0, Trackable::OBJTYPE_FENCE)
 {
@@ -39,6 +48,10 @@ CQ::CQ(int fd, Trackable::ObjType objBeingCreated) :
 
 CQ::~CQ()
 {
+    char desc[32];
+    snprintf(desc, sizeof(desc), "CQ %d wait latency", GetQId());
+    mWaitLatency.Log(desc, "us");
+
     // Cleanup duties for this Q's buffer
     if (GetIsContig()) {
         // Contiguous memory is alloc'd and owned by the kernel
@@ -252,8 +265,7 @@ CQ::ReapInquiry(uint32_t &isrCount, bool reportOn0)
 
     isrCount = inq.isr_count;
     if (inq.num_remaining || reportOn0) {
-        LOG_NRM("%d CE's awaiting attention in CQ %d, ISR count: %d",
-            inq.num_remaining, inq.q_id, isrCount);
+        LOG_TRACE(TRC_CQ_INQUIRY, inq.num_remaining, inq.q_id, isrCount);
     }
     return inq.num_remaining;
 }
@@ -268,16 +280,9 @@ CQ::ReapInquiryWaitAny(uint32_t ms, uint32_t &numCE, uint32_t &isrCount)
     if (ms > 86400000)
         LOG_WARN("Waiting > 1 day, is this reasonable?");
 
-    struct timeval initial;
-    if (gettimeofday(&initial, NULL) != 0)
-        throw FrmwkEx(HERE, "Cannot retrieve system time");
-
-    while (CalcTimeout(ms, initial, delta) == false) {
-        if ((numCE = ReapInquiry(isrCount)) != 0) {
-            LOG_NRM("Waited for CE(s) approx: %d ms", delta);
-            return true;
-        }
-        usleep(10);
+    if (WaitForCE(ms, 1, numCE, isrCount, delta)) {
+        LOG_TRACE(TRC_CQ_WAITED, delta);
+        return true;
     }
 
     LOG_ERR("Timed out waiting %d ms for any CE in CQ %d, found %d",
@@ -305,18 +310,9 @@ CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
     if (ms > 86400000)
         throw FrmwkEx(HERE, "Waiting > 1 day, is this reasonable?");
 
-    struct timeval initial;
-    if (gettimeofday(&initial, NULL) != 0)
-        throw FrmwkEx(HERE, "Cannot retrieve system time");
-
-    while (CalcTimeout(ms, initial, delta) == false) {
-        if ((numCE = ReapInquiry(isrCount)) != 0) {
-            if (numCE >= numTil) {
-                LOG_NRM("Waited for CE(s) approx: %d ms", delta);
-                return true;
-            }
-        }
-        usleep(10);
+    if (WaitForCE(ms, numTil, numCE, isrCount, delta)) {
+        LOG_TRACE(TRC_CQ_WAITED, delta);
+        return true;
     }
 
     LOG_ERR("Timed out waiting %d ms for %d CE's in CQ %d, found %d",
@@ -335,18 +331,57 @@ CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
 
 
 bool
-CQ::CalcTimeout(uint32_t ms, struct timeval &initial, uint32_t &delta)
+CQ::WaitForCE(uint32_t ms, uint32_t numTil, uint32_t &numCE,
+    uint32_t &isrCount, uint32_t &delta)
 {
-    struct timeval current;
+    time_t delta_us = 0;
+    useconds_t backoff = 1;
 
-    if (gettimeofday(&current, NULL) != 0)
+    struct timespec initial;
+    if (clock_gettime(CLOCK_MONOTONIC, &initial) != 0)
         throw FrmwkEx(HERE, "Cannot retrieve system time");
 
-    time_t initial_us = (((time_t)1000000 * initial.tv_sec) + initial.tv_usec);
-    time_t current_us = (((time_t)1000000 * current.tv_sec) + current.tv_usec);
-    time_t timeout_us = ((time_t)ms * (time_t)1000);
-    time_t delta_us = (current_us - initial_us);
+    numCE = 0;
+    while (CalcTimeout(ms, initial, delta_us) == false) {
+        numCE = ReapInquiry(isrCount);
+        if (numCE && (numCE >= numTil)) {
+            delta = (delta_us / 1000UL);
+            mWaitLatency.Record(delta_us);
+            return true;
+        }
+
+        if (gCmdLine.cqWait == CQWAIT_ADAPTIVE) {
+            // Most CE's arrive within a few us, so the syscall overhead of
+            // sleeping would only add latency; thereafter don't hog the CPU.
+            if (delta_us < CQWAIT_SPIN_US)
+                continue;
+            usleep(backoff);
+            backoff = MIN((backoff * 2), CQWAIT_MAX_BACKOFF_US);
+        } else {
+            usleep(10);
+        }
+    }
+
     delta = (delta_us / 1000UL);
+    return false;
+}
+
+
+bool
+CQ::CalcTimeout(uint32_t ms, struct timespec &initial, time_t &delta_us)
+{
+    struct timespec current;
+
+    // A monotonic clock is immune to wall clock adjustments during a wait
+    if (clock_gettime(CLOCK_MONOTONIC, &current) != 0)
+        throw FrmwkEx(HERE, "Cannot retrieve system time");
+
+    time_t initial_us = (((time_t)1000000 * initial.tv_sec) +
+        (initial.tv_nsec / 1000));
+    time_t current_us = (((time_t)1000000 * current.tv_sec) +
+        (current.tv_nsec / 1000));
+    time_t timeout_us = ((time_t)ms * (time_t)1000);
+    delta_us = (current_us - initial_us);
     if (delta_us >= timeout_us) {
         LOG_NRM("Timeout: (cur - init) >= TO: (%ld - %ld) >= %ld",
             current_us, initial_us, timeout_us);
@@ -360,9 +395,6 @@ uint32_t
 CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
     uint32_t ceDesire, bool zeroMem)
 {
-    int rc;
-    struct nvme_reap reap;
-
     // The tough part of reaping all which can be reaped, indicated by
     // (ceDesire == 0), is that CE's can be arriving from hdw between the time
     // one calls ReapInquiry() and Reap(). In essence this indicates we really
@@ -383,17 +415,54 @@ CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
     if (zeroMem)
         memBuffer->Zero();
 
+    return ReapToDnvme(ceDesire, memBuffer->GetBuffer(),
+        memBuffer->GetBufSize(), ceRemain, isrCount);
+}
+
+
+CESpan
+CQ::ReapToScratch(uint32_t &ceRemain, uint32_t &isrCount, uint32_t ceDesire)
+{
+    // Per NVME spec: 1 empty CE implies a full CQ, can't truly fill all
+    if ((ceDesire == 0) || (ceDesire > (GetNumEntries() - 1)))
+        ceDesire = (GetNumEntries() - 1);
+
+    // The CE's are returned from a buffer which is allocated once for the
+    // lifetime of this CQ. Dnvme alone tracks the CQ's head ptr, which it
+    // resets whenever the ctrlr is disabled, thus the CE's copied out by
+    // dnvme are the only ones known to be the CE's just reaped.
+    if (mReapScratch.size() < GetQSize())
+        mReapScratch.resize(GetQSize());
+
+    uint32_t numReaped = ReapToDnvme(ceDesire, &mReapScratch[0],
+        (GetEntrySize() * ceDesire), ceRemain, isrCount);
+    return CESpan((const union CE *)&mReapScratch[0], numReaped);
+}
+
+
+uint32_t
+CQ::ReapToDnvme(uint32_t ceDesire, uint8_t *buffer, uint32_t bufSize,
+    uint32_t &ceRemain, uint32_t &isrCount)
+{
+    int rc;
+    struct nvme_reap reap;
+
     reap.q_id = GetQId();
     reap.elements = ceDesire;
-    reap.size = memBuffer->GetBufSize();
-    reap.buffer = memBuffer->GetBuffer();
+    reap.size = bufSize;
+    reap.buffer = buffer;
     if ((rc = ioctl(mFd, NVME_IOCTL_REAP, &reap)) < 0)
         throw FrmwkEx(HERE, "Error during reaping CE's, rc =%d", rc);
 
+    uint64_t reapNs = CmdLatency::Now();
+    const union CE *ce = (const union CE *)buffer;
+    for (uint32_t i = 0; i < reap.num_reaped; i++)
+        CmdLatency::Reap(ce[i].n.SQID, ce[i].n.CID, reapNs);
+
     isrCount = reap.isr_count;
     ceRemain = reap.num_remaining;
-    LOG_NRM("Reaped %d CE's, %d remain, from CQ %d, ISR count: %d",
-        reap.num_reaped, reap.num_remaining, GetQId(), isrCount);
+    LOG_TRACE(TRC_CQ_REAP, reap.num_reaped, reap.num_remaining, GetQId(),
+        isrCount);
     return reap.num_reaped;
 }
 
@@ -401,20 +470,25 @@ CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
 void
 CQ::Dump(DumpFilename filename, string fileHdr)
 {
-    FILE *fp;
-    union CE ce;
-    vector<string> desc;
-
     Queue::Dump(filename, fileHdr);
 
-    // Reopen the file and append the same data in a different format
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    // Append the same data in a different format
+    DeferredDump::Capture(filename, RenderDecoded, GetQBuffer(), GetQSize(),
+        GetEntrySize());
+}
+
+
+void
+CQ::RenderDecoded(FILE *fp, DumpFilename, const uint8_t *raw,
+    size_t len, uint32_t entrySize, const string &)
+{
+    union CE ce;
+    vector<string> desc;
 
     fprintf(fp, "\nFurther decoding details of the above raw dump follow:\n");
-    for (uint32_t i = 0; i < GetNumEntries(); i++) {
-        ce = PeekCE(i);
-        fprintf(fp, "CE %d @ 0x%08X:\n", i, (i * GetEntrySize()));
+    for (uint32_t i = 0; i < (len / sizeof(union CE)); i++) {
+        memcpy(&ce, (raw + (i * sizeof(union CE))), sizeof(union CE));
+        fprintf(fp, "CE %d @ 0x%08X:\n", i, (i * entrySize));
         fprintf(fp, "  Cmd specific: 0x%08X\n", ce.n.cmdSpec);
         fprintf(fp, "  Reserved:     0x%08X\n", ce.n.reserved);
         fprintf(fp, "  SQ head ptr:  0x%04X\n", ce.n.SQHD);
@@ -425,8 +499,6 @@ CQ::Dump(DumpFilename filename, string fileHdr)
         for (size_t j = 0; j < desc.size(); j++ )
             fprintf(fp, "  %s\n", desc[j].c_str());
     }
-
-    fclose(fp);
 }
 
 
@@ -19,6 +19,7 @@
 
 #include "queue.h"
 #include "ce.h"
+#include "../Utils/histogram.h"
 
 class CQ;    // forward definition
 typedef boost::shared_ptr<CQ>               SharedCQPtr;
@@ -26,6 +27,30 @@ typedef boost::shared_ptr<CQ>               SharedCQPtr;
         boost::shared_polymorphic_downcast<CQ>(shared_trackable_ptr);
 
 
+/**
+* A lightweight, non-owning view of consecutive CE's as returned by
+* CQ::ReapToScratch(). The CE's reside within a scratch reap buffer owned by
+* the CQ, thus the view is only valid until the next call to
+* CQ::ReapToScratch() on the same CQ.
+*/
+class CESpan
+{
+public:
+    CESpan() : mCE(NULL), mCount(0) {}
+    CESpan(const union CE *ce, uint32_t count) : mCE(ce), mCount(count) {}
+
+    uint32_t size() const { return mCount; }
+    bool empty() const { return (mCount == 0); }
+
+    /// @param idx Pass [0 to (size()-1)]; not range checked
+    const union CE &operator[](uint32_t idx) const { return mCE[idx]; }
+
+private:
+    const union CE *mCE;
+    uint32_t mCount;
+};
+
+
 /**
 * This class extends the base class. It is also not meant to be instantiated.
 * This class contains all things common to CQ's at a high level. After
@@ -159,6 +184,24 @@ public:
     uint32_t Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer,
         uint32_t &isrCount, uint32_t ceDesire = 0, bool zeroMem = false);
 
+    /**
+     * Reap a specified number of CE's from this CQ, but rather than copying
+     * the CE's into a caller supplied MemBuffer, return a view of the CE's
+     * within a reap buffer allocated once for the lifetime of this CQ. No
+     * memory is allocated nor zeroed per call, thus this is the preferred
+     * manner to reap from performance sensitive code. Calling this method
+     * when (ReapInquiry() == 0) is fine.
+     * @param ceRemain Returns the number of CE's left in the CQ after reaping
+     * @param isrCount Returns the number of ISR's which fired and were counted
+     *        that are assoc with this CQ. If this CQ does not use IRQ's, then
+     *        this value will remain 0.
+     * @param ceDesire Pass the number of CE's desired to be reaped, 0 indicates
+     *      reap all which can be reaped.
+     * @return A view of the CE's actually reaped
+     */
+    CESpan ReapToScratch(uint32_t &ceRemain, uint32_t &isrCount,
+        uint32_t ceDesire = 0);
+
 
 protected:
     /**
@@ -194,20 +237,57 @@ private:
     bool mIrqEnabled;
     uint16_t mIrqVec;
 
+    /// Scratch buffer dnvme copies CE's into, see ReapToScratch()
+    vector<uint8_t> mReapScratch;
+
+    /// DumpRenderFn decoding every CE of a raw CQ snapshot, see DeferredDump
+    static void RenderDecoded(FILE *fp, DumpFilename, const uint8_t *raw,
+        size_t len, uint32_t entrySize, const string &);
+
+    /**
+     * Issue the reap ioctl and advance the head ptr accordingly.
+     * @param ceDesire Pass the number of CE's desired to be reaped, 0 indicates
+     *      reap all which can be reaped.
+     * @param buffer Pass the memory into which dnvme copies the CE's
+     * @param bufSize Pass the size of the buffer in bytes
+     * @param ceRemain Returns the number of CE's left in the CQ after reaping
+     * @param isrCount Returns the number of ISR's which fired and were counted
+     * @return Returns the actual number of CE's reaped
+     */
+    uint32_t ReapToDnvme(uint32_t ceDesire, uint8_t *buffer, uint32_t bufSize,
+        uint32_t &ceRemain, uint32_t &isrCount);
+
+    /// Latency in us of every successful ReapInquiryWait*() for this CQ
+    Histogram mWaitLatency;
+
     /**
      * Create an IOCQ
      * @param q Pass the IOCQ's definition
      */
     void CreateIOCQ(struct nvme_prep_cq &q);
 
+    /**
+     * Wait until at least the specified number of CE's become available or
+     * until a time out period expires. The manner of waiting is dictated by
+     * the cmd line option gCmdLine.cqWait.
+     * @param ms Pass the max number of ms to wait until numTil CE's arrive.
+     * @param numTil Pass the number of CE's that need to become available
+     * @param numCE Returns the number of unreap'd CE's awaiting
+     * @param isrCount Returns the number of ISR's which fired and were counted
+     * @param delta Returns the number of ms which were waited
+     * @return true when CE's are awaiting to be reaped, otherwise a timeout
+     */
+    bool WaitForCE(uint32_t ms, uint32_t numTil, uint32_t &numCE,
+        uint32_t &isrCount, uint32_t &delta);
+
     /**
      * Calculate if a timeout (TO) period has expired
      * @param ms Pass the number of ms indicating the TO period
      * @param initial Pass the time when the period starting
-     * @param delta Return the calc'd time passage as the number of ms.
+     * @param delta_us Return the calc'd time passage as the number of us.
      * @return true if the TO has expired, false otherwise
      */
-    bool CalcTimeout(uint32_t ms, struct timeval &initial, uint32_t &delta);
+    bool CalcTimeout(uint32_t ms, struct timespec &initial, time_t &delta_us);
 };
 
 
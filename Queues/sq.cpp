@@ -17,6 +17,8 @@
 #include "sq.h"
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/cmdLatency.h"
+#include "../Utils/traceLog.h"
 
 SharedSQPtr SQ::NullSQPtr;
 
@@ -55,6 +57,7 @@ SQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries, uint16_t cqId)
 
     mCqId = cqId;
     Queue::Init(qId, entrySize, numEntries);
+    CmdLatency::InitSQ(qId, numEntries);
     LOG_NRM("Create SQ: (id,cqid,entrySize,numEntries) = (%d,%d,%d,%d)",
         GetQId(), GetCqId(), GetEntrySize(), GetNumEntries());
 
@@ -124,6 +127,7 @@ SQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries,
 
     mCqId = cqId;
     Queue::Init(qId, entrySize, numEntries);
+    CmdLatency::InitSQ(qId, numEntries);
     LOG_NRM("Create SQ: (id,cqid,entrySize,numEntries) = (%d,%d,%d,%d)",
         GetQId(), GetCqId(), GetEntrySize(), GetNumEntries());
 
@@ -256,14 +260,51 @@ SQ::LogSE(uint16_t indexPtr)
 void
 SQ::Send(SharedCmdPtr cmd, uint16_t &uniqueId)
 {
-    int rc;
-    struct nvme_64b_send io;
+    // Detect if doing something that looks suspicious/incorrect/illegal
+    if (gCtrlrConfig->IsStateEnabled() == false)
+        LOG_WARN("Sending cmds to a disabled DUT is suspicious");
+
+    LOG_TRACE(TRC_SQ_SEND, cmd->GetOpcode(), cmd->GetPrpBufferSize(),
+        GetQId());
+
+    // Allow tnvme to learn of the unique cmd ID which was assigned by dnvme
+    uniqueId = SendToDnvme(cmd);
+}
+
 
+void
+SQ::SendBatch(vector<SharedCmdPtr> &cmds, vector<uint16_t> &uniqueIds,
+    bool ring)
+{
+    uniqueIds.clear();
+    if (cmds.empty())
+        throw FrmwkEx(HERE, "A batch must contain >= 1 cmd");
+    else if (cmds.size() > (GetNumEntries() - 1))
+        throw FrmwkEx(HERE, "Batch of %ld cmds can never fit within SQ %d",
+            cmds.size(), GetQId());
 
     // Detect if doing something that looks suspicious/incorrect/illegal
     if (gCtrlrConfig->IsStateEnabled() == false)
         LOG_WARN("Sending cmds to a disabled DUT is suspicious");
 
+    // dnvme only supports submitting a single cmd per ioctl, thus the batch
+    // is staged 1 cmd at a time, but w/o the per cmd overhead of Send().
+    LOG_TRACE(TRC_SQ_SEND_BATCH, cmds.size(), cmds[0]->GetOpcode(), GetQId());
+    uniqueIds.reserve(cmds.size());
+    for (size_t i = 0; i < cmds.size(); i++)
+        uniqueIds.push_back(SendToDnvme(cmds[i]));
+
+    if (ring)
+        Ring();
+}
+
+
+uint16_t
+SQ::SendToDnvme(SharedCmdPtr cmd)
+{
+    int rc;
+    struct nvme_64b_send io;
+
     io.q_id = GetQId();
     io.bit_mask = (send_64b_bitmask)(cmd->GetPrpBitmask() |
         cmd->GetMetaBitmask());
@@ -273,15 +314,32 @@ SQ::Send(SharedCmdPtr cmd, uint16_t &uniqueId)
     io.cmd_buf_ptr = cmd->GetCmd()->GetBuffer();
     io.data_dir = cmd->GetDataDir();
 
-    LOG_NRM("Send cmd opcode 0x%02X, payload size 0x%04X, to SQ id 0x%02X",
-        cmd->GetOpcode(), io.data_buf_size, io.q_id);
-
+    uint64_t sendNs = CmdLatency::Now();
     if ((rc = ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &io)) < 0)
         throw FrmwkEx(HERE, "Error sending cmd, rc =%d", rc);
 
-    // Allow tnvme to learn of the unique cmd ID which was assigned by dnvme
-    uniqueId = io.unique_id;
+    CmdLatency::Send(GetQId(), io.unique_id, sendNs);
     cmd->SetCID(io.unique_id);
+    return io.unique_id;
+}
+
+
+uint16_t
+SQ::SendTemplate(CmdTemplate &tmpl)
+{
+    int rc;
+
+    tmpl.mIO.q_id = GetQId();
+    uint64_t sendNs = CmdLatency::Now();
+    if ((rc = ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &tmpl.mIO)) < 0)
+        throw FrmwkEx(HERE, "Error sending cmd, rc =%d", rc);
+
+    CmdLatency::Send(GetQId(), tmpl.mIO.unique_id, sendNs);
+
+    // Same as Cmd::SetCID(), w/o the logging
+    tmpl.mDW[0] = ((tmpl.mDW[0] & 0x0000ffff) |
+        ((uint32_t)tmpl.mIO.unique_id << 16));
+    return tmpl.mIO.unique_id;
 }
 
 
@@ -291,7 +349,8 @@ SQ::Ring()
     int rc;
     uint16_t sqId = GetQId();
 
-    LOG_NRM("Ring doorbell for SQ %d", sqId);
+    LOG_TRACE(TRC_SQ_RING, sqId);
+    CmdLatency::Ring(sqId, CmdLatency::Now());
     if ((rc = ioctl(mFd, NVME_IOCTL_RING_SQ_DOORBELL, sqId)) < 0)
         throw FrmwkEx(HERE, "Error ringing doorbell, rc =%d", rc);
 }
@@ -21,6 +21,7 @@
 #include "se.h"
 #include "backdoor.h"
 #include "../Cmds/cmd.h"
+#include "../Cmds/cmdTemplate.h"
 
 class SQ;    // forward definition
 typedef boost::shared_ptr<SQ>               SharedSQPtr;
@@ -80,6 +81,29 @@ public:
      */
     virtual void Send(SharedCmdPtr cmd, uint16_t &uniqueId);
 
+    /**
+     * Issue a batch of cmds to this queue in a single call, and optionally
+     * ring the doorbell once the entire batch has been staged. The checks and
+     * logging which Send() performs per cmd are performed once per batch,
+     * which is what makes submitting (CAP.MQES + 1) cmds affordable.
+     * @note The same cmd object may appear multiple times in the batch, its
+     *       CID will reflect the last submission.
+     * @param cmds Pass the cmds to send to this queue, in submission order
+     * @param uniqueIds Returns the dnvme assigned unique cmd ID's, where
+     *        uniqueIds[i] correlates to cmds[i].
+     * @param ring Pass true to ring the doorbell after the batch is staged
+     */
+    void SendBatch(vector<SharedCmdPtr> &cmds, vector<uint16_t> &uniqueIds,
+        bool ring);
+
+    /**
+     * Issue the cmd of a template to this queue, but does not ring any
+     * doorbell. Intended for hot loops, thus nothing is checked nor logged.
+     * @param tmpl Pass the template to send to this queue
+     * @return The dnvme assigned unique cmd ID
+     */
+    uint16_t SendTemplate(CmdTemplate &tmpl);
+
     /**
      * Ring the doorbell assoc with this SQ. This will commit to hardware all
      * prior cmds which were sent via Send().
@@ -118,6 +142,14 @@ private:
 
     uint16_t mCqId;
 
+    /**
+     * Issue the specified cmd to dnvme without any of the sanity checks or
+     * logging which are the responsibility of the callers.
+     * @param cmd Pass the cmd to send to this queue.
+     * @return The dnvme assigned unique cmd ID
+     */
+    uint16_t SendToDnvme(SharedCmdPtr cmd);
+
     /**
      * Create an IOSQ
      * @param q Pass the IOSQ's definition
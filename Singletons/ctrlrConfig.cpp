@@ -53,6 +53,9 @@ CtrlrConfig::CtrlrConfig(int fd, SpecRev specRev) :
         throw FrmwkEx(HERE, "Object created with a bad FD=%d", fd);
 
     mSpecRev = specRev;
+    mShadowEnabled = false;
+    mShadowValid = false;
+    mShadowHits = 0;
 
     uint64_t tmp;
     gRegisters->Read(CTLSPC_CAP, tmp);
@@ -201,11 +204,41 @@ CtrlrConfig::DecodeIrqScheme(enum nvme_irq_type newIrq, string &desc)
 
 bool
 CtrlrConfig::IsStateEnabled()
+{
+    if (mShadowValid == false) {
+        // CSTS.RDY may still be in transition, don't cache the answer
+        uint64_t tmp = 0;
+        if (gRegisters->Read(CTLSPC_CSTS, tmp))
+            return (tmp & CSTS_RDY);
+        return false;
+    }
+
+    // IOEngine workers call this concurrently via SQ::Send(), thus only the
+    // caller crossing the threshold rereads CSTS and reloads the shadow
+    if (__sync_add_and_fetch(&mShadowHits, 1) == CTRLR_STATE_REVALIDATE)
+        return RevalidateState();
+    return mShadowEnabled;
+}
+
+
+bool
+CtrlrConfig::RevalidateState()
 {
     uint64_t tmp = 0;
-    if (gRegisters->Read(CTLSPC_CSTS, tmp))
-        return (tmp & CSTS_RDY);
-    return false;
+    if (gRegisters->Read(CTLSPC_CSTS, tmp) == false) {
+        mShadowValid = false;
+        return false;
+    }
+
+    bool enabled = (tmp & CSTS_RDY);
+    if (mShadowValid && (mShadowEnabled != enabled)) {
+        LOG_WARN("Ctrlr state changed behind tnvme's back, now %s",
+            enabled ? "enabled" : "disabled");
+    }
+    mShadowEnabled = enabled;
+    mShadowValid = true;
+    mShadowHits = 0;
+    return enabled;
 }
 
 
@@ -233,12 +266,18 @@ CtrlrConfig::SetState(enum nvme_state state)
 
     LOG_NRM("%s the NVME device", toState.c_str());
     if (ioctl(mFd, NVME_IOCTL_DEVICE_STATE, state) < 0) {
+        mShadowValid = false;
         LOG_ERR("Could not set state, currently %s",
             IsStateEnabled() ? "enabled" : "disabled");
         LOG_NRM("dnvme waits a TO period for CC.RDY to indicate ready" );
         return false;
     }
 
+    // dnvme has waited upon CSTS.RDY to reflect the new state
+    mShadowEnabled = (state == ST_ENABLE);
+    mShadowValid = true;
+    mShadowHits = 0;
+
     // The state of the ctrlr is important to many objects
     Notify(state);
 
@@ -261,6 +300,10 @@ CtrlrConfig::WriteRegCC(uint32_t regVal)
 {
     uint64_t tmp =  regVal;
     bool retVal = gRegisters->Write(CTLSPC_CC, tmp);
+
+    // Toggling CC.EN leaves CSTS.RDY to follow at the DUT's pace
+    if (((regVal & CC_EN) != 0) != mShadowEnabled)
+        mShadowValid = false;
     return retVal;
 }
 
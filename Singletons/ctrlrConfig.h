@@ -26,6 +26,9 @@
 typedef StateObserver<enum nvme_state> ObserverCtrlrState;
 typedef StateSubject<enum nvme_state>  SubjectCtrlrState;
 
+/// Number of IsStateEnabled() answers from the shadow between CSTS reads
+#define CTRLR_STATE_REVALIDATE      1024
+
 
 /**
 * This class is the access to the Controller Configuration (CC) register. It
@@ -92,11 +95,24 @@ public:
     bool IsMSIXCapable(bool &capable, uint16_t &numIrqs);
 
     /**
-     * Is the controller enabled?
+     * Is the controller enabled? The answer comes from a shadow of CSTS.RDY
+     * which SetState() keeps coherent, thus it costs no register access.
+     * Every CTRLR_STATE_REVALIDATE calls CSTS is reread to catch the DUT
+     * changing state on its own. After CC.EN is toggled via WriteRegCC()
+     * CSTS is read upon every call until SetState() or RevalidateState().
+     * @note Safe to be called concurrently, e.g. by IOEngine workers
      * @return true if enabled, otherwise false
      */
     bool IsStateEnabled();
 
+    /**
+     * Reads CSTS.RDY from the DUT and reloads the shadow state with it,
+     * warning should the shadow have disagreed. Call this after causing
+     * the DUT to change state by any means other than SetState().
+     * @return true if enabled, otherwise false
+     */
+    bool RevalidateState();
+
     /**
      * Set the state of the controller.
      * @param state Pass {ST_ENABLE | ST_DISABLE | ST_DISABLE_COMPLETELY}
@@ -154,6 +170,12 @@ private:
     /// Current value of controller capabilities register
     uint32_t mRegCAP;
 
+    /// Shadow of CSTS.RDY, only to be trusted when mShadowValid is true
+    bool mShadowEnabled;
+    bool mShadowValid;
+    /// Number of IsStateEnabled() answers since CSTS was last read, atomic
+    uint32_t mShadowHits;
+
     bool GetRegValue(uint8_t &value, uint32_t regMask, uint8_t bitShift);
     bool SetRegValue(uint8_t value, uint8_t valueMask, uint64_t regMask,
         uint8_t bitShift);
@@ -14,16 +14,93 @@
  *  limitations under the License.
  */
 
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
 #include "informative.h"
 #include "globals.h"
 #include "../Exception/frmwkEx.h"
 #include "../Cmds/getFeatures.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/io.h"
+#include "../Utils/aerService.h"
 
 #define GRP_NAME        "singleton"
 #define TEST_NAME       "informative"
 
+/// Depth of the admin Q's created by Init(), bounds the identify pipeline
+#define INIT_ADMIN_Q_DEPTH      64
+
+/// On disk cache of identify data, see Informative::LoadCache()
+#define IDCACHE_FILE            "/informative.idcache"
+#define IDCACHE_MAGIC           "TNVMEIDC"
+#define IDCACHE_VERSION         1
+
+/**
+ * Header of the cache file. The identify ctrlr struct follows, then NN
+ * identify namspc structs in NSID order, each of dataSize bytes. The SN, MN
+ * and FR copies make the file self describing, the entire identify ctrlr
+ * struct is what must match.
+ */
+struct IdCacheHdr {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    dataSize;
+    uint32_t    numNamspc;
+    uint32_t    rsvd;
+    char        sn[20];     // Identify ctrlr bytes 4:23
+    char        mn[40];     // Identify ctrlr bytes 24:63
+    char        fr[8];      // Identify ctrlr bytes 64:71
+};
+
+
+/**
+* Supplies the identify namspc cmds for NSID's 1 through NN to IO::Pipeline().
+* Each cmd keeps its own data buffer, because that buffer is the identify
+* data which Informative retains for the life of the group.
+*/
+class IdNamspcGenerator : public CmdGenerator
+{
+public:
+    /**
+     * @param numNamSpc Pass the number of namspc's reported by the ctrlr
+     * @param idCmds Returns every cmd handed out, in NSID order
+     */
+    IdNamspcGenerator(uint64_t numNamSpc, vector<SharedIdentifyPtr> &idCmds) :
+        mNumNamSpc(numNamSpc), mNextNamSpc(1), mIdCmds(idCmds) {}
+    virtual ~IdNamspcGenerator() {}
+
+    virtual bool Next(SharedCmdPtr &cmd);
+
+
+private:
+    uint64_t mNumNamSpc;
+    uint64_t mNextNamSpc;
+    vector<SharedIdentifyPtr> &mIdCmds;
+};
+
+
+bool
+IdNamspcGenerator::Next(SharedCmdPtr &cmd)
+{
+    if (mNextNamSpc > mNumNamSpc)
+        return false;
+
+    SharedIdentifyPtr idCmdNamSpc = SharedIdentifyPtr(new Identify());
+    idCmdNamSpc->SetCNS(false);
+    idCmdNamSpc->SetNSID(mNextNamSpc++);
+    SharedMemBufferPtr idMemNamSpc = SharedMemBufferPtr(new MemBuffer());
+    idMemNamSpc->InitAlignment(Identify::IDEAL_DATA_SIZE,
+        PRP_BUFFER_ALIGNMENT, true, 0);
+    send_64b_bitmask idPrpNamSpc =
+        (send_64b_bitmask)(MASK_PRP1_PAGE | MASK_PRP2_PAGE);
+    idCmdNamSpc->SetPrpBuffer(idPrpNamSpc, idMemNamSpc);
+
+    mIdCmds.push_back(idCmdNamSpc);
+    cmd = idCmdNamSpc;
+    return true;
+}
+
 
 bool Informative::mInstanceFlag = false;
 Informative *Informative::mSingleton = NULL;
@@ -76,6 +153,7 @@ Informative::Clear()
 {
     mIdentifyCmdCtrlr = Identify::NullIdentifyPtr;
     mIdentifyCmdNamspc.clear();
+    mNamspcIndex = NamspcIndex();
     mGetFeaturesNumOfQ = 0;
 }
 
@@ -158,203 +236,78 @@ Informative::GetFeaturesNumOfIOSQs() const
 }
 
 
-vector<uint32_t>
-Informative::GetBareNamespaces() const
-{
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    // Bare namespaces supporting no meta data, and E2E is disabled;
-    // Implies: Identify.LBAF[Identify.FLBAS].MS=0
-    LOG_NRM("Seeking all bare namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        if (IdentifyNamespace(nsPtr) == NS_BARE) {
-            LOG_NRM("Identified bare namspc #%ld", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetMetaNamespaces() const
-{
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all meta namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if ((nsType == NS_METAI) || (nsType == NS_METAS)) {
-            LOG_NRM("Identified meta namspc with %s buffer (ID = %ld)",
-                (nsType == NS_METAI) ? "interleaved" : "separate", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetMetaINamespaces() const
-{
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all interleaved meta namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if (nsType == NS_METAI) {
-            LOG_NRM(
-                "Identified meta namspc with interleaved buffer (ID = %ld)", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetMetaSNamespaces() const
-{
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all separate meta namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if (nsType == NS_METAS) {
-            LOG_NRM(
-                "Identified meta namspc with separate buffer (ID = %ld)", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetE2eNamespaces() const
-{
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all E2E namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if ((nsType == NS_E2EI) || (nsType == NS_E2ES)) {
-            LOG_NRM("Identified E2E namspc with %s buffer (ID = %ld)",
-                (nsType == NS_E2EI) ? "interleaved" : "separate", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetE2eINamespaces() const
-{
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all interleaved E2E namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if (nsType == NS_E2EI) {
-            LOG_NRM(
-                "Identified E2E namspc with interleaved buffer (ID = %ld)", i);
-            ns.push_back(i);
-        }
-    }
-    return ns;
-}
-
-
-vector<uint32_t>
-Informative::GetE2eSNamespaces() const
+void
+Informative::BuildNamspcIndex()
 {
-    NamspcType nsType;
-    vector<uint32_t> ns;
-    ConstSharedIdentifyPtr nsPtr;
-
-    // Determine the Number of Namespaces (NN)
-    ConstSharedIdentifyPtr idCmdCtrlr = GetIdentifyCmdCtrlr();
-    uint32_t nn = (uint32_t)idCmdCtrlr->GetValue(IDCTRLRCAP_NN);
-
-    LOG_NRM("Seeking all separate E2E namspc's");
-    for (uint64_t i = 1; i <= nn; i++) {
-        nsPtr =  GetIdentifyCmdNamspc(i);
-        nsType = IdentifyNamespace(nsPtr);
-        if (nsType == NS_E2ES) {
-            LOG_NRM("Identified E2E namspc with separate buffer (ID = %ld)", i);
-            ns.push_back(i);
+    NamspcIndex &idx = mNamspcIndex;
+    size_t nn = mIdentifyCmdNamspc.size();
+
+    idx = NamspcIndex();
+    idx.nsze.reserve(nn);
+    idx.ncap.reserve(nn);
+    idx.lbaDataSize.reserve(nn);
+    idx.ms.reserve(nn);
+    idx.type.reserve(nn);
+
+    LOG_NRM("Indexing %lu namspc's by type", nn);
+    for (uint32_t i = 1; i <= nn; i++) {
+        ConstSharedIdentifyPtr nsPtr = GetIdentifyCmdNamspc(i);
+        NamspcType nsType = IdentifyNamespace(nsPtr);
+
+        idx.nsze.push_back(nsPtr->GetValue(IDNAMESPC_NSZE));
+        idx.ncap.push_back(nsPtr->GetValue(IDNAMESPC_NCAP));
+        idx.lbaDataSize.push_back(nsPtr->GetLBADataSize());
+        idx.ms.push_back(nsPtr->GetLBAFormat().MS);
+        idx.type.push_back(nsType);
+
+        switch (nsType) {
+        case NS_BARE:
+            idx.bare.push_back(i);
+            break;
+        case NS_METAI:
+            idx.metaI.push_back(i);
+            idx.meta.push_back(i);
+            break;
+        case NS_METAS:
+            idx.metaS.push_back(i);
+            idx.meta.push_back(i);
+            break;
+        case NS_E2EI:
+            idx.e2eI.push_back(i);
+            idx.e2e.push_back(i);
+            break;
+        case NS_E2ES:
+            idx.e2eS.push_back(i);
+            idx.e2e.push_back(i);
+            break;
         }
     }
-    return ns;
+    LOG_NRM("Namspc's: bare=%lu, metaI=%lu, metaS=%lu, e2eI=%lu, e2eS=%lu",
+        idx.bare.size(), idx.metaI.size(), idx.metaS.size(), idx.e2eI.size(),
+        idx.e2eS.size());
 }
 
 
 Informative::Namspc
 Informative::Get1stBareMetaE2E() const
 {
-    vector<uint32_t> namspc;
-
-    namspc= GetBareNamespaces();
-    if (namspc.size())
-        return (Namspc(GetIdentifyCmdNamspc(namspc[0]), namspc[0], NS_BARE));
-
-    namspc = GetMetaSNamespaces();
-    if (namspc.size())
-        return (Namspc(GetIdentifyCmdNamspc(namspc[0]), namspc[0], NS_METAS));
-
-    namspc = GetMetaINamespaces();
-    if (namspc.size())
-        return (Namspc(GetIdentifyCmdNamspc(namspc[0]), namspc[0], NS_METAI));
-
-    namspc = GetE2eSNamespaces();
-    if (namspc.size())
-        return (Namspc(GetIdentifyCmdNamspc(namspc[0]), namspc[0], NS_E2ES));
-
-    namspc = GetE2eINamespaces();
-    if (namspc.size())
-        return (Namspc(GetIdentifyCmdNamspc(namspc[0]), namspc[0], NS_E2EI));
+    const NamspcIndex &idx = mNamspcIndex;
+
+    if (idx.bare.size())
+        return (Namspc(GetIdentifyCmdNamspc(idx.bare[0]), idx.bare[0],
+            NS_BARE));
+    if (idx.metaS.size())
+        return (Namspc(GetIdentifyCmdNamspc(idx.metaS[0]), idx.metaS[0],
+            NS_METAS));
+    if (idx.metaI.size())
+        return (Namspc(GetIdentifyCmdNamspc(idx.metaI[0]), idx.metaI[0],
+            NS_METAI));
+    if (idx.e2eS.size())
+        return (Namspc(GetIdentifyCmdNamspc(idx.e2eS[0]), idx.e2eS[0],
+            NS_E2ES));
+    if (idx.e2eI.size())
+        return (Namspc(GetIdentifyCmdNamspc(idx.e2eI[0]), idx.e2eI[0],
+            NS_E2EI));
 
     throw FrmwkEx(HERE, "DUT must have 1 of 3 namspc's");
 }
@@ -420,14 +373,14 @@ Informative::Init()
 
         LOG_NRM("Prepare the admin Q's to setup this request");
         SharedACQPtr acq = SharedACQPtr(new ACQ(gDutFd));
-        acq->Init(2);
+        acq->Init(INIT_ADMIN_Q_DEPTH);
         SharedASQPtr asq = SharedASQPtr(new ASQ(gDutFd));
-        asq->Init(2);
+        asq->Init(INIT_ADMIN_Q_DEPTH);
         gCtrlrConfig->SetCSS(CtrlrConfig::CSS_NVM_CMDSET);
         if (gCtrlrConfig->SetState(ST_ENABLE) == false)
             throw FrmwkEx(HERE);
 
-        status = Reinit(asq, acq, CALC_TIMEOUT_ms(1));
+        status = Reinit(asq, acq, CALC_TIMEOUT_ms(1), true);
     } catch (...) {
         LOG_ERR("Failed to init Informative singleton");
         status = false;
@@ -439,7 +392,8 @@ Informative::Init()
 
 
 bool
-Informative::Reinit(SharedASQPtr &asq, SharedACQPtr &acq, uint16_t ms)
+Informative::Reinit(SharedASQPtr &asq, SharedACQPtr &acq, uint16_t ms,
+    bool cached)
 {
     LOG_NRM("------------gInformative(re/init) START------------");
 
@@ -461,7 +415,11 @@ Informative::Reinit(SharedASQPtr &asq, SharedACQPtr &acq, uint16_t ms)
 
     SendGetFeaturesNumOfQueues(asq, acq, ms);
     SendIdentifyCtrlrStruct(asq, acq, ms);
-    SendIdentifyNamespaceStruct(asq, acq, ms);
+    if ((cached == false) || (LoadCache() == false)) {
+        SendIdentifyNamespaceStruct(asq, acq, ms);
+        SaveCache();
+    }
+    BuildNamspcIndex();
 
     // Change dump dir to be compatible for test execution
     FileSystem::SetBaseDumpDir(false);
@@ -589,30 +547,151 @@ Informative::SendIdentifyNamespaceStruct(SharedASQPtr asq, SharedACQPtr acq,
 
     LOG_NRM("Gather %lld identify namspc structs from DUT",
         (unsigned long long)numNamSpc);
-    for (uint64_t namSpc = 1; namSpc <= numNamSpc; namSpc++) {
-        LOG_NRM("-------------start(ID namspc %ld struct)------------", namSpc);
-        snprintf(qualifier, sizeof(qualifier), "idCmdNamSpc-%llu",
-            (long long unsigned int)namSpc);
+    mIdentifyCmdNamspc.reserve(numNamSpc);
+
+    // An AER service owns reaping the ACQ, thus fall back to 1 cmd at a time
+    if (AERService::GetActive(acq) != NULL) {
+        IdNamspcGenerator gen(numNamSpc, mIdentifyCmdNamspc);
+        SharedCmdPtr cmd;
+        for (uint64_t namSpc = 1; gen.Next(cmd); namSpc++) {
+            snprintf(qualifier, sizeof(qualifier), "idCmdNamSpc-%llu",
+                (long long unsigned int)namSpc);
+            IO::SendAndReapCmd(GRP_NAME, TEST_NAME, ms, asq, acq, cmd,
+                qualifier, false);
+        }
+        return;
+    }
+
+    // Keep the ASQ full, the CE's are matched back to their cmds regardless
+    // of completion order and only errors produce dump files.
+    IdNamspcGenerator gen(numNamSpc, mIdentifyCmdNamspc);
+    uint64_t numDone = IO::Pipeline(GRP_NAME, TEST_NAME, ms, asq, acq, gen,
+        asq->GetNumEntries(), "idCmdNamSpc", false);
+    if (numDone != numNamSpc) {
+        throw FrmwkEx(HERE, "Gathered %llu of %llu identify namspc structs",
+            (unsigned long long)numDone, (unsigned long long)numNamSpc);
+    }
+}
+
+
+string
+Informative::GetCacheFile(bool evenIfDisabled)
+{
+    if (((gCmdLine.idCache == false) && (evenIfDisabled == false)) ||
+        gCmdLine.dump.empty()) {
+        return "";
+    }
+    return (gCmdLine.dump + IDCACHE_FILE);
+}
+
+
+void
+Informative::InvalidateCache()
+{
+    // A cache left by a prior instance is stale even if this one ignores it
+    string file = GetCacheFile(true);
+    if (file.empty())
+        return;
+
+    if ((unlink(file.c_str()) == 0) || (errno == ENOENT)) {
+        LOG_NRM("Invalidated identify cache: %s", file.c_str());
+    } else {
+        LOG_WARN("Unable to invalidate %s: %s", file.c_str(), strerror(errno));
+    }
+}
+
+
+bool
+Informative::LoadCache()
+{
+    IdCacheHdr hdr;
+    string file = GetCacheFile();
+    if (file.empty())
+        return false;
+
+    FILE *fp = fopen(file.c_str(), "r");
+    if (fp == NULL) {
+        LOG_NRM("No identify cache to adopt: %s", file.c_str());
+        return false;
+    }
 
-        LOG_NRM("Create identify cmd #%llu & assoc some buffer memory",
-            (long long unsigned int)namSpc);
+    // The DUT must report exactly what it reported when the cache was made
+    uint64_t numNamSpc = mIdentifyCmdCtrlr->GetValue(IDCTRLRCAP_NN);
+    vector<uint8_t> work(Identify::IDEAL_DATA_SIZE);
+    bool usable = ((fread(&hdr, sizeof(hdr), 1, fp) == 1) &&
+        (memcmp(hdr.magic, IDCACHE_MAGIC, sizeof(hdr.magic)) == 0) &&
+        (hdr.version == IDCACHE_VERSION) &&
+        (hdr.dataSize == Identify::IDEAL_DATA_SIZE) &&
+        (hdr.numNamspc == numNamSpc) &&
+        (fread(&work[0], work.size(), 1, fp) == 1) &&
+        (memcmp(&work[0], mIdentifyCmdCtrlr->GetROPrpBuffer(),
+        work.size()) == 0));
+
+    for (uint64_t namSpc = 1; usable && (namSpc <= numNamSpc); namSpc++) {
         SharedIdentifyPtr idCmdNamSpc = SharedIdentifyPtr(new Identify());
-        LOG_NRM("Force identify to request namespace struct #%llu",
-            (long long unsigned int)namSpc);
         idCmdNamSpc->SetCNS(false);
         idCmdNamSpc->SetNSID(namSpc);
         SharedMemBufferPtr idMemNamSpc = SharedMemBufferPtr(new MemBuffer());
         idMemNamSpc->InitAlignment(Identify::IDEAL_DATA_SIZE,
-            PRP_BUFFER_ALIGNMENT, true, 0);
+            PRP_BUFFER_ALIGNMENT, false, 0);
+        if (fread(idMemNamSpc->GetBuffer(), Identify::IDEAL_DATA_SIZE, 1,
+            fp) != 1) {
+            usable = false;
+            break;
+        }
         send_64b_bitmask idPrpNamSpc =
             (send_64b_bitmask)(MASK_PRP1_PAGE | MASK_PRP2_PAGE);
         idCmdNamSpc->SetPrpBuffer(idPrpNamSpc, idMemNamSpc);
+        mIdentifyCmdNamspc.push_back(idCmdNamSpc);
+    }
+    fclose(fp);
 
-        IO::SendAndReapCmd(GRP_NAME, TEST_NAME, ms, asq, acq,
-            idCmdNamSpc, qualifier, true);
+    if (usable == false) {
+        LOG_NRM("Identify cache is stale or corrupt: %s", file.c_str());
+        mIdentifyCmdNamspc.clear();
+        return false;
+    }
+    LOG_NRM("Adopted %llu identify namspc structs from cache: %s",
+        (unsigned long long)numNamSpc, file.c_str());
+    return true;
+}
 
-        // This data is static; allows all tests to extract from common point
-        mIdentifyCmdNamspc.push_back(idCmdNamSpc);
-        LOG_NRM("-------------end(ID namspc %ld struct)-------------", namSpc);
+
+void
+Informative::SaveCache() const
+{
+    IdCacheHdr hdr;
+    string file = GetCacheFile();
+    if (file.empty())
+        return;
+
+    const uint8_t *ctrlr = mIdentifyCmdCtrlr->GetROPrpBuffer();
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, IDCACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = IDCACHE_VERSION;
+    hdr.dataSize = Identify::IDEAL_DATA_SIZE;
+    hdr.numNamspc = mIdentifyCmdNamspc.size();
+    memcpy(hdr.sn, (ctrlr + 4), sizeof(hdr.sn));
+    memcpy(hdr.mn, (ctrlr + 24), sizeof(hdr.mn));
+    memcpy(hdr.fr, (ctrlr + 64), sizeof(hdr.fr));
+
+    // Write aside and rename, a reader never sees a partial cache
+    string tmpFile = file + ".tmp";
+    FILE *fp = fopen(tmpFile.c_str(), "w");
+    if (fp == NULL) {
+        LOG_WARN("Unable to create %s: %s", tmpFile.c_str(), strerror(errno));
+        return;
+    }
+
+    bool ok = ((fwrite(&hdr, sizeof(hdr), 1, fp) == 1) &&
+        (fwrite(ctrlr, Identify::IDEAL_DATA_SIZE, 1, fp) == 1));
+    for (size_t i = 0; ok && (i < mIdentifyCmdNamspc.size()); i++) {
+        ok = (fwrite(mIdentifyCmdNamspc[i]->GetROPrpBuffer(),
+            Identify::IDEAL_DATA_SIZE, 1, fp) == 1);
+    }
+    if ((fclose(fp) != 0) || (ok == false) ||
+        (rename(tmpFile.c_str(), file.c_str()) != 0)) {
+        LOG_WARN("Unable to write identify cache: %s", file.c_str());
+        unlink(tmpFile.c_str());
     }
 }
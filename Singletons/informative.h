@@ -62,12 +62,26 @@ public:
      * framework has no idea that some object caused its config to change.
      * @note The assumption here is that both the asq and acq's must be empty,
      *       and the DUT must be currently enabled.
+     * Regardless, the identify data fetched is written to the on disk cache,
+     * see LoadCache().
      * @param asq Pass pre-existing ASQ in which to issue admin cmds
      * @param acq Pass pre-existing ACQ to reap any correlating CE's
      * @param ms Pass the max number of ms to wait until numTil CE's arrive.
+     * @param cached Pass true to accept the identify namspc data of the on
+     *        disk cache when it matches the DUT, false to always refetch it
      * @return true upon success, otherwise false.
      */
-    bool Reinit(SharedASQPtr &asq, SharedACQPtr &acq, uint16_t ms);
+    bool Reinit(SharedASQPtr &asq, SharedACQPtr &acq, uint16_t ms,
+        bool cached = false);
+
+    /**
+     * Delete the on disk cache of identify data. Any action which changes
+     * the DUT's identify data w/o changing its SN, MN nor FR, e.g. a format
+     * NVM, must invoke this, otherwise the next instance of tnvme will adopt
+     * stale data.
+     * @note This method will not throw
+     */
+    static void InvalidateCache();
 
     /**
      * Get a previously fetched identify command's controller struct.
@@ -112,7 +126,8 @@ public:
 
     /**
      * Retrieve an array indicating all the namespace ID(s) for the appropriate
-     * namespace type desired.
+     * namespace type desired. The arrays are built once by Reinit(), thus
+     * these are O(1) and silent.
      * @note Bare: Namespaces supporting no meta data, and E2E is
      *       disabled; Implies: Identify.LBAF[Identify.FLBAS].MS=0
      * @note Meta: Namespaces supporting meta data, and E2E is disabled;
@@ -120,16 +135,44 @@ public:
      * @note E2E: Namespaces supporting meta data, and E2E is enabled;
      *       Implies: Identify.LBAF[Identify.FLBAS].MS=!0, Identify.DPS_b2:0=!0
      * @return vector containing all desired namespace IDs; it could be an empty
-     *       vector indicating no namespaces are present in the DUT, otherwise
-     *       throws if anything prevents detecting the requested data.
+     *       vector indicating no namespaces are present in the DUT.
      */
-    vector<uint32_t> GetBareNamespaces() const;
-    vector<uint32_t> GetMetaINamespaces() const;    // meta data interleaved
-    vector<uint32_t> GetMetaSNamespaces() const;    // meta data separate
-    vector<uint32_t> GetMetaNamespaces() const;     // interleaved and separate
-    vector<uint32_t> GetE2eINamespaces() const;     // E2E interleaved
-    vector<uint32_t> GetE2eSNamespaces() const;     // E2E separate
-    vector<uint32_t> GetE2eNamespaces() const;      // interleaved and separate
+    const vector<uint32_t> &GetBareNamespaces() const
+        { return mNamspcIndex.bare; }
+    const vector<uint32_t> &GetMetaINamespaces() const   // meta interleaved
+        { return mNamspcIndex.metaI; }
+    const vector<uint32_t> &GetMetaSNamespaces() const   // meta separate
+        { return mNamspcIndex.metaS; }
+    const vector<uint32_t> &GetMetaNamespaces() const    // interleaved+separate
+        { return mNamspcIndex.meta; }
+    const vector<uint32_t> &GetE2eINamespaces() const    // E2E interleaved
+        { return mNamspcIndex.e2eI; }
+    const vector<uint32_t> &GetE2eSNamespaces() const    // E2E separate
+        { return mNamspcIndex.e2eS; }
+    const vector<uint32_t> &GetE2eNamespaces() const     // interleaved+separate
+        { return mNamspcIndex.e2e; }
+
+    /**
+     * The hot fields of every namspc, decoded once by Reinit() and laid out
+     * as a struct of arrays, each indexed by (namspc ID - 1). Also holds the
+     * per type namspc ID arrays returned by Get*Namespaces().
+     */
+    struct NamspcIndex {
+        vector<uint64_t>    nsze;
+        vector<uint64_t>    ncap;
+        vector<uint64_t>    lbaDataSize;    // Identify::GetLBADataSize()
+        vector<uint16_t>    ms;             // LBAF[FLBAS].MS
+        vector<NamspcType>  type;
+
+        vector<uint32_t>    bare;
+        vector<uint32_t>    metaI;
+        vector<uint32_t>    metaS;
+        vector<uint32_t>    meta;
+        vector<uint32_t>    e2eI;
+        vector<uint32_t>    e2eS;
+        vector<uint32_t>    e2e;
+    };
+    const NamspcIndex &GetNamspcIndex() const { return mNamspcIndex; }
 
     struct Namspc {
         ConstSharedIdentifyPtr idCmdNamspc; // Namespace data struct
@@ -176,12 +219,37 @@ private:
     uint32_t mGetFeaturesNumOfQ;
     SharedIdentifyPtr mIdentifyCmdCtrlr;
     vector<SharedIdentifyPtr> mIdentifyCmdNamspc;
+    NamspcIndex mNamspcIndex;
     void SendGetFeaturesNumOfQueues(SharedASQPtr asq, SharedACQPtr acq,
         uint16_t ms);
     void SendIdentifyCtrlrStruct(SharedASQPtr asq, SharedACQPtr acq,
         uint16_t ms);
     void SendIdentifyNamespaceStruct(SharedASQPtr asq, SharedACQPtr acq,
         uint16_t ms);
+
+    /// Decode mIdentifyCmdNamspc into mNamspcIndex
+    void BuildNamspcIndex();
+
+    /**
+     * @param evenIfDisabled Pass true to ignore cmd line option -I
+     * @return The filename of the on disk cache, empty if disabled
+     */
+    static string GetCacheFile(bool evenIfDisabled = false);
+
+    /**
+     * Adopt the identify namspc structs from the on disk cache, if and only
+     * if the cache was recorded for a DUT reporting the very same identify
+     * ctrlr struct as mIdentifyCmdCtrlr, which is keyed by SN, MN and FR.
+     * @note This method will not throw
+     * @return true if adopted, false if there is no usable cache
+     */
+    bool LoadCache();
+
+    /**
+     * Record mIdentifyCmdCtrlr and mIdentifyCmdNamspc into the on disk cache.
+     * @note This method will not throw
+     */
+    void SaveCache() const;
 };
 
 
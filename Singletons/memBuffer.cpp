@@ -17,9 +17,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "memBuffer.h"
 #include "../Utils/buffers.h"
+#include "../Utils/patternGen.h"
+#include "../Utils/bufferPool.h"
 #include "../Exception/frmwkEx.h"
+#include "globals.h"
 
 SharedMemBufferPtr MemBuffer::NullMemBufferPtr;
 
@@ -50,8 +56,10 @@ MemBuffer::~MemBuffer()
 void
 MemBuffer::InitMemberVariables()
 {
-    mAllocByNewOperator = true;
     mRealBaseAddr = NULL;
+    mRealBufSize = 0;
+    mRealAlign = 0;
+    mMapped = false;
     mVirBaseAddr = NULL;
     mVirBufSize = 0;
     mAlignment = 0;
@@ -61,24 +69,34 @@ MemBuffer::InitMemberVariables()
 void
 MemBuffer::DeallocateResources()
 {
-    // Either new or posix_memalign() was used to allocate memory
-    if (mAllocByNewOperator) {
-        if (mRealBaseAddr)
-            delete [] mRealBaseAddr;
+    if (mMapped) {
+        munmap(mRealBaseAddr, mRealBufSize);
     } else {
-        if (mRealBaseAddr)
-            free(mRealBaseAddr);
+        // Recycle the memory for the next buffer of this size class
+        BufferPool::Free(mRealBaseAddr, mRealBufSize, mRealAlign);
     }
     InitMemberVariables();
 }
 
 
+void
+MemBuffer::AllocateResources(uint32_t size, uint32_t align)
+{
+    try {
+        mRealBaseAddr = BufferPool::Alloc(size, align);
+    } catch (...) {
+        InitMemberVariables();
+        throw;
+    }
+    mRealBufSize = size;
+    mRealAlign = align;
+}
+
+
 void
 MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     bool initMem, uint8_t initVal)
 {
-    int err;
-    uint32_t realBufSize;
     uint32_t align = sysconf(_SC_PAGESIZE);
 
 
@@ -93,19 +111,12 @@ MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
 
     // All memory is allocated page aligned, offsets into the 1st page requires
     // asking for more memory than the caller desires and then tracking the
     // virtual pointer into the real allocation as a side affect.
     mVirBufSize = bufSize;
-    realBufSize = (bufSize + offset1stPg);
-    err = posix_memalign((void **)&mRealBaseAddr, align, realBufSize);
-    if (err) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
-            err);
-    }
+    AllocateResources((bufSize + offset1stPg), align);
     mVirBaseAddr = (mRealBaseAddr + offset1stPg);
     if (offset1stPg)
         mAlignment = offset1stPg;
@@ -121,8 +132,6 @@ void
 MemBuffer::InitAlignment(uint32_t bufSize, uint32_t align, bool initMem,
     uint8_t initVal)
 {
-    int err;
-
     LOG_NRM("Init buffer; size: 0x%08X, align: 0x%08X, init: %d, value: 0x%02X",
         bufSize, align, initMem, initVal);
     if (align % sizeof(void *) != 0) {
@@ -133,15 +142,9 @@ MemBuffer::InitAlignment(uint32_t bufSize, uint32_t align, bool initMem,
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
 
     mVirBufSize = bufSize;
-    err = posix_memalign((void **)&mRealBaseAddr, align, mVirBufSize);
-    if (err) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
-            err);
-    }
+    AllocateResources(mVirBufSize, align);
     mVirBaseAddr = mRealBaseAddr;
     mAlignment = align;
 
@@ -159,14 +162,9 @@ MemBuffer::Init(uint32_t bufSize, bool initMem, uint8_t initVal)
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = true;
 
     mVirBufSize = bufSize;
-    mRealBaseAddr = new (nothrow) uint8_t[mVirBufSize];
-    if (mRealBaseAddr == NULL) {
-        InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed");
-    }
+    AllocateResources(mVirBufSize, sizeof(void *));
     mVirBaseAddr = mRealBaseAddr;
     mAlignment = 0;
 
@@ -175,6 +173,61 @@ MemBuffer::Init(uint32_t bufSize, bool initMem, uint8_t initVal)
 }
 
 
+void
+MemBuffer::InitHugePage(uint32_t bufSize, bool initMem, uint8_t initVal)
+{
+    uint8_t *addr;
+    uint32_t mapSize;
+
+    // Page aligned classes of the pool are carved from the hugepage arena
+    if ((gCmdLine.hugePages == 0) ||
+        (bufSize <= (1U << BUFPOOL_MAX_CLASS_SHIFT))) {
+        InitAlignment(bufSize, sysconf(_SC_PAGESIZE), initMem, initVal);
+        return;
+    }
+
+    LOG_NRM("Init hugepage buffer; size: 0x%08X, init: %d, value: 0x%02X",
+        bufSize, initMem, initVal);
+
+    // Support resizing/reallocation
+    if (mRealBaseAddr != NULL)
+        DeallocateResources();
+
+    // Too large for the pool. Fault in and lock every page now, rather than
+    // leaving dnvme to fault them in 1 by 1 while pinning the PRP's.
+    mapSize = MAX(((bufSize + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE),
+        1) * HUGEPAGE_SIZE;
+    addr = (uint8_t *)mmap(NULL, mapSize, (PROT_READ | PROT_WRITE),
+        (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE), -1, 0);
+    if (addr == MAP_FAILED) {
+        LOG_WARN("Hugepages unavailable (%s), using regular pages",
+            strerror(errno));
+        InitAlignment(bufSize, sysconf(_SC_PAGESIZE), initMem, initVal);
+        return;
+    }
+    if (mlock(addr, mapSize) != 0)
+        LOG_WARN("Unable to mlock hugepage buffer: %s", strerror(errno));
+
+    mRealBaseAddr = addr;
+    mRealBufSize = mapSize;
+    mRealAlign = HUGEPAGE_SIZE;
+    mMapped = true;
+    mVirBaseAddr = mRealBaseAddr;
+    mVirBufSize = bufSize;
+    mAlignment = HUGEPAGE_SIZE;
+
+    if (initMem)
+        memset(mVirBaseAddr, initVal, mVirBufSize);
+}
+
+
+bool
+MemBuffer::IsHugePage()
+{
+    return (mMapped || BufferPool::IsHugePage(mRealBaseAddr));
+}
+
+
 uint8_t
 MemBuffer::GetAt(size_t offset)
 {
@@ -201,7 +254,7 @@ void
 MemBuffer::SetDataPattern(DataPattern dataPat, uint64_t initVal,
     uint32_t offset, uint32_t length)
 {
-    LOG_NRM("Write data pattern: initial value = 0x%016llX",
+    LOG_NRM("Write data pattern %d: initial value = 0x%016llX", dataPat,
         (long long unsigned int)initVal);
 
     if (mRealBaseAddr == NULL)
@@ -211,67 +264,80 @@ MemBuffer::SetDataPattern(DataPattern dataPat, uint64_t initVal,
     if ((length + offset) > GetBufSize())
         throw FrmwkEx(HERE, "Length exceeds total buffer size");
 
-    switch (dataPat)
-    {
-    case DATAPAT_CONST_8BIT:
-        {
-            LOG_NRM("Write data pattern: constant 8 bit");
-            uint8_t *rawPtr = (uint8_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_16BIT:
-        {
-            LOG_NRM("Write data pattern: constant 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_32BIT:
-        {
-            LOG_NRM("Write data pattern: constant 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal;
-        }
-        break;
-
-    case DATAPAT_INC_8BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 8 bit");
-            uint8_t *rawPtr = (uint8_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal++;
-        }
-        break;
-
-    case DATAPAT_INC_16BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetBuffer() + offset);
-            LOG_NRM("Length = %d GetBufSize = %d, offset = %d", length,
-                GetBufSize(), offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal++;
+    PatternGen::Fill(dataPat, initVal, (GetBuffer() + offset), length);
+}
+
+
+bool
+MemBuffer::VerifyPattern(DataPattern dataPat, uint64_t initVal,
+    uint32_t offset, uint32_t length, MismatchReport &report)
+{
+    LOG_NRM("Verify data pattern %d: initial value = 0x%016llX", dataPat,
+        (long long unsigned int)initVal);
+
+    if (offset > GetBufSize())
+        throw FrmwkEx(HERE, "Offset exceeds total buffer size");
+    length = (length == UINT32_MAX) ? (GetBufSize() - offset) : length;
+    if ((length + offset) > GetBufSize())
+        throw FrmwkEx(HERE, "Length exceeds total buffer size");
+
+    if (PatternGen::Verify(dataPat, initVal, (GetBuffer() + offset), length,
+        report, offset) == false) {
+        report.Log();
+        return false;
+    }
+    return true;
+}
+
+
+void
+MemBuffer::SetLBATagPattern(uint32_t blkSize, uint32_t nsid, uint64_t slba,
+    uint32_t gen, uint32_t numBlks)
+{
+    LOG_NRM("Write LBA tagged pattern: (nsid,slba,gen) = (%d,0x%016llX,%d)",
+        nsid, (long long unsigned int)slba, gen);
+
+    if (blkSize == 0)
+        throw FrmwkEx(HERE, "Illegal blk size of 0");
+    if (numBlks == 0) {
+        if (GetBufSize() % blkSize) {
+            throw FrmwkEx(HERE, "Buffer size is not a multiple of blk size %d",
+                blkSize);
         }
-        break;
-
-    case DATAPAT_INC_32BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal++;
+        numBlks = (GetBufSize() / blkSize);
+    } else if (((uint64_t)numBlks * blkSize) > GetBufSize()) {
+        throw FrmwkEx(HERE, "%d blks exceed total buffer size", numBlks);
+    }
+    LBATag::Fill(GetBuffer(), blkSize, numBlks, nsid, slba, gen);
+}
+
+
+bool
+MemBuffer::VerifyLBATagPattern(uint32_t blkSize, uint32_t nsid, uint64_t slba,
+    uint32_t gen, LBATagReport &report, uint32_t numBlks)
+{
+    LOG_NRM("Verify LBA tagged pattern: (nsid,slba,gen) = (%d,0x%016llX,%d)",
+        nsid, (long long unsigned int)slba, gen);
+
+    if (blkSize == 0)
+        throw FrmwkEx(HERE, "Illegal blk size of 0");
+    if (numBlks == 0) {
+        if (GetBufSize() % blkSize) {
+            throw FrmwkEx(HERE, "Buffer size is not a multiple of blk size %d",
+                blkSize);
         }
-        break;
+        numBlks = (GetBufSize() / blkSize);
+    } else if (((uint64_t)numBlks * blkSize) > GetBufSize()) {
+        throw FrmwkEx(HERE, "%d blks exceed total buffer size", numBlks);
+    }
 
-    default:
-        throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+    report.Clear();
+    if (LBATag::Verify(GetBuffer(), blkSize, numBlks, nsid, slba, gen,
+        report) == false) {
+        report.Log();
+        return false;
     }
+    return true;
 }
 
 
@@ -22,6 +22,8 @@
 #include "trackable.h"
 #include "limits.h"
 #include "../Utils/fileSystem.h"
+#include "../Utils/patternGen.h"
+#include "../Utils/lbaTag.h"
 
 #define PRP_BUFFER_ALIGNMENT        128
 
@@ -36,7 +38,8 @@ typedef boost::shared_ptr<MemBuffer>            SharedMemBufferPtr;
 * be created and destroyed by the RsrcMngr, however that is not strictly
 * necessary. These buffers can be specified to have certain alignment criteria
 * to be used for CQ/SQ memory and user data buffers. After instantiation the
-* Initxxxxxx() methods must be called to attain something useful.
+* Initxxxxxx() methods must be called to attain something useful. Memory is
+* drawn from, and returned to, the BufferPool.
 *
 * @note This class may throw exceptions.
 */
@@ -97,6 +100,26 @@ public:
      */
     void Init(uint32_t bufSize, bool initMem = false, uint8_t initVal = 0);
 
+    /**
+     * Allocates page aligned memory intended for large data transfers. When
+     * the cmd line requests hugepages (--hugepages) the buffer is carved from
+     * the hugepage arena BufferPool reserved, populated and mlock'd, at
+     * startup; buffers larger than the pool's largest size class are mapped
+     * from hugepages directly. The PRP's still describe every memory page,
+     * but dnvme finds those pages already resident when pinning them and
+     * the TLB covers the buffer w/ few entries. Otherwise, or if hugepages
+     * are unavailable, this falls back to page aligned memory identically
+     * to InitAlignment().
+     * @param bufSize Pass the number of bytes for buffer creation
+     * @param initMem Pass true to initialize all elements, otherwise don't init
+     * @param initVal Pass the init value if suppose to init the buffer
+     */
+    void InitHugePage(uint32_t bufSize, bool initMem = false,
+        uint8_t initVal = 0);
+
+    /// @return true if the buffer is currently backed by hugepages
+    bool IsHugePage();
+
     /**
      * Get the buffer's byte value at the provided offset from beginning of
      * the buffer.
@@ -127,6 +150,53 @@ public:
     /// Zero out all memory bytes
     void Zero() { SetDataPattern(DATAPAT_CONST_8BIT, 0); }
 
+    /**
+     * Verify a segment of the data buffer contains a data pattern, as would
+     * have been written by SetDataPattern() using identical parameters. The
+     * expected pattern is regenerated on the fly, thus no 2nd buffer holding
+     * the expected data is needed to compare against.
+     * @param dataPat Pass the data pattern/series which is expected
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param offset Pass offset into the data buf which is start of the segment
+     * @param length Pass the number of bytes of the segment length, value
+     *        of UINT32_MAX implies infinite length.
+     * @param report Returns the 1st mismatching offsets along with their
+     *        expected and actual values, offsets are relative to GetBuffer().
+     * @return true upon all data matching, false upon any miscompare, which
+     *      is also logged.
+     */
+    bool VerifyPattern(DataPattern dataPat, uint64_t initVal, uint32_t offset,
+        uint32_t length, MismatchReport &report);
+
+    /**
+     * Write the LBA tagged pattern, see class LBATag, to the start of the
+     * data buffer.
+     * @param blkSize Pass the LBA data size of the namspc
+     * @param nsid Pass the NSID the buffer will be written to
+     * @param slba Pass the LBA the buffer will be written to
+     * @param gen Pass the write generation to embed in every blk
+     * @param numBlks Pass the number of logical blks to write, 0 indicates
+     *      the entire buffer, which must then only hold whole blks.
+     */
+    void SetLBATagPattern(uint32_t blkSize, uint32_t nsid, uint64_t slba,
+        uint32_t gen, uint32_t numBlks = 0);
+
+    /**
+     * Verify the start of the data buffer holds the LBA tagged pattern, see
+     * class LBATag, w/o needing the buffer which was written.
+     * @param blkSize Pass the LBA data size of the namspc
+     * @param nsid Pass the NSID the buffer was read from
+     * @param slba Pass the LBA the buffer was read from
+     * @param gen Pass the write generation every blk ought to hold
+     * @param report Returns the state of every blk; it is cleared 1st
+     * @param numBlks Pass the number of logical blks to verify, 0 indicates
+     *      the entire buffer, which must then only hold whole blks.
+     * @return true upon every blk being intact, in place and of the expected
+     *      generation, otherwise false, which is also logged.
+     */
+    bool VerifyLBATagPattern(uint32_t blkSize, uint32_t nsid, uint64_t slba,
+        uint32_t gen, LBATagReport &report, uint32_t numBlks = 0);
+
     /**
      * Compare a specified MemBuffer to this one.
      * @param compTo Pass a reference to the memory to compare against
@@ -154,13 +224,16 @@ public:
 
 
 private:
-    bool mAllocByNewOperator;
-    uint8_t *mRealBaseAddr;     // System address returned by posix_memalign()
+    uint8_t *mRealBaseAddr;     // Address returned by BufferPool::Alloc()
+    uint32_t mRealBufSize;      // Size passed to BufferPool::Alloc()
+    uint32_t mRealAlign;        // Alignment passed to BufferPool::Alloc()
+    bool mMapped;               // mmap'd hugepages rather than from the pool
     uint8_t *mVirBaseAddr;      // User buffer address to satisfy mOffset1stPg
     uint32_t mVirBufSize;       // User request buffer size
     uint32_t mAlignment;
 
     void InitMemberVariables();
+    void AllocateResources(uint32_t size, uint32_t align);
     void DeallocateResources();
 };
 
@@ -14,6 +14,7 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include "registers.h"
 #include "tnvme.h"
 #include "../Exception/frmwkEx.h"
@@ -304,6 +305,62 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
 }
 
 
+bool
+Registers::Snapshot(RegSnapshot &snap, bool verbose)
+{
+    int rc;
+    uint32_t pciEnd = 0;
+    uint32_t ctlEnd = 0;
+
+    // Only span as far as the last register we know how to decode
+    for (int i = 0; i < PCISPC_FENCE; i++) {
+        if ((mPciSpcMetrics[i].specRev == mSpecRev) &&
+            (mPciSpcMetrics[i].offset != USHRT_MAX)) {
+            pciEnd = MAX(pciEnd, (uint32_t)mPciSpcMetrics[i].offset +
+                mPciSpcMetrics[i].size);
+        }
+    }
+    for (int i = 0; i < CTLSPC_FENCE; i++) {
+        if ((mCtlSpcMetrics[i].specRev == mSpecRev) &&
+            (mCtlSpcMetrics[i].offset != USHRT_MAX)) {
+            ctlEnd = MAX(ctlEnd, (uint32_t)mCtlSpcMetrics[i].offset +
+                mCtlSpcMetrics[i].size);
+        }
+    }
+    ctlEnd = (ctlEnd + 3) & ~3;     // dword access width
+
+    snap.mValid = false;
+    snap.mSpecRev = mSpecRev;
+    snap.mPciMetrics = mPciSpcMetrics;
+    snap.mCtlMetrics = mCtlSpcMetrics;
+    snap.mPci.resize(pciEnd);
+    snap.mCtl.resize(ctlEnd);
+
+    struct rw_generic pci = { NVMEIO_PCI_HDR, 0, pciEnd, BYTE_LEN,
+        &snap.mPci[0] };
+    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &pci)) < 0) {
+        LOG_ERR("Error reading 0x%04X bytes of PCI space: %d returned",
+            pciEnd, rc);
+        return false;
+    }
+
+    struct rw_generic ctl = { NVMEIO_BAR01, 0, ctlEnd, DWORD_LEN,
+        &snap.mCtl[0] };
+    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &ctl)) < 0) {
+        LOG_ERR("Error reading 0x%04X bytes of ctrlr space: %d returned",
+            ctlEnd, rc);
+        return false;
+    }
+
+    if (verbose) {
+        LOG_NRM("Snapshot of 0x%04X bytes PCI space, 0x%04X bytes ctrlr space",
+            pciEnd, ctlEnd);
+    }
+    snap.mValid = true;
+    return true;
+}
+
+
 string
 Registers::FormatRegister(uint16_t regSize, const char *regDesc,
     uint64_t regValue)
@@ -502,3 +559,140 @@ Registers::DiscoverPciCapabilities()
 }
 
 
+
+
+RegSnapshot::RegSnapshot()
+{
+    mValid = false;
+    mSpecRev = SPECREVTYPE_FENCE;
+    mPciMetrics = NULL;
+    mCtlMetrics = NULL;
+}
+
+
+const uint8_t *
+RegSnapshot::Locate(const vector<uint8_t> &space, uint16_t offset,
+    uint16_t size, SpecRev specRev) const
+{
+    if ((mValid == false) || (specRev != mSpecRev))
+        return NULL;
+    else if ((offset == USHRT_MAX) ||
+        (((uint32_t)offset + size) > space.size())) {
+        return NULL;
+    }
+    return &space[offset];
+}
+
+
+const uint8_t *
+RegSnapshot::GetRaw(PciSpc reg) const
+{
+    if (mValid == false)
+        return NULL;
+    return Locate(mPci, mPciMetrics[reg].offset, mPciMetrics[reg].size,
+        mPciMetrics[reg].specRev);
+}
+
+
+const uint8_t *
+RegSnapshot::GetRaw(CtlSpc reg) const
+{
+    if (mValid == false)
+        return NULL;
+    return Locate(mCtl, mCtlMetrics[reg].offset, mCtlMetrics[reg].size,
+        mCtlMetrics[reg].specRev);
+}
+
+
+bool
+RegSnapshot::Get(PciSpc reg, uint64_t &value) const
+{
+    const uint8_t *raw = GetRaw(reg);
+    if ((raw == NULL) || (mPciMetrics[reg].size > MAX_SUPPORTED_REG_SIZE))
+        return false;
+
+    uint64_t work = 0;
+    memcpy(&work, raw, mPciMetrics[reg].size);
+    value = REGMASK(work, mPciMetrics[reg].size);
+    return true;
+}
+
+
+bool
+RegSnapshot::Get(CtlSpc reg, uint64_t &value) const
+{
+    const uint8_t *raw = GetRaw(reg);
+    if ((raw == NULL) || (mCtlMetrics[reg].size > MAX_SUPPORTED_REG_SIZE))
+        return false;
+
+    uint64_t work = 0;
+    memcpy(&work, raw, mCtlMetrics[reg].size);
+    value = REGMASK(work, mCtlMetrics[reg].size);
+    return true;
+}
+
+
+void
+RegSnapshot::Diff(const RegSnapshot &after, vector<RegDelta> &delta) const
+{
+    delta.clear();
+    if ((mValid == false) || (after.mValid == false))
+        return;
+
+    if (mPci != after.mPci) {
+        for (int i = 0; i < PCISPC_FENCE; i++) {
+            const uint8_t *a = GetRaw((PciSpc)i);
+            const uint8_t *b = after.GetRaw((PciSpc)i);
+            if ((a == NULL) || (b == NULL) ||
+                (memcmp(a, b, mPciMetrics[i].size) == 0)) {
+                continue;
+            }
+
+            RegDelta d = { NVMEIO_PCI_HDR, i, 0, 0 };
+            Get((PciSpc)i, d.before);
+            after.Get((PciSpc)i, d.after);
+            delta.push_back(d);
+        }
+    }
+
+    if (mCtl != after.mCtl) {
+        for (int i = 0; i < CTLSPC_FENCE; i++) {
+            const uint8_t *a = GetRaw((CtlSpc)i);
+            const uint8_t *b = after.GetRaw((CtlSpc)i);
+            if ((a == NULL) || (b == NULL) ||
+                (memcmp(a, b, mCtlMetrics[i].size) == 0)) {
+                continue;
+            }
+
+            RegDelta d = { NVMEIO_BAR01, i, 0, 0 };
+            Get((CtlSpc)i, d.before);
+            after.Get((CtlSpc)i, d.after);
+            delta.push_back(d);
+        }
+    }
+}
+
+
+void
+RegSnapshot::LogDiff(const RegSnapshot &after) const
+{
+    vector<RegDelta> delta;
+
+    if ((mValid == false) || (after.mValid == false)) {
+        LOG_NRM("Unable to diff registers, a snapshot is missing");
+        return;
+    }
+
+    Diff(after, delta);
+    if (delta.empty()) {
+        LOG_NRM("No register values have changed");
+        return;
+    }
+    for (size_t i = 0; i < delta.size(); i++) {
+        const char *desc = (delta[i].space == NVMEIO_PCI_HDR) ?
+            mPciMetrics[delta[i].reg].desc : mCtlMetrics[delta[i].reg].desc;
+        LOG_NRM("Changed %s: 0x%016llX -> 0x%016llX", desc,
+            (unsigned long long)delta[i].before,
+            (unsigned long long)delta[i].after);
+    }
+}
@@ -30,6 +30,84 @@
         (regval & (0xffffffffffffffffULL >> (64 - (bytes * 8))))
 
 
+/// A register whose value differs between 2 snapshots, see RegSnapshot::Diff
+struct RegDelta {
+    nvme_io_space   space;      // NVMEIO_PCI_HDR or NVMEIO_BAR01
+    int             reg;        // PciSpc or CtlSpc, depending upon space
+    uint64_t        before;     // 0 if reg > MAX_SUPPORTED_REG_SIZE bytes
+    uint64_t        after;      // 0 if reg > MAX_SUPPORTED_REG_SIZE bytes
+};
+
+
+/**
+* This class is a copy of all of PCI space, including the discovered
+* capabilities, and all of ctrlr space, taken at one instant by
+* Registers::Snapshot(). Individual registers are decoded out of the copy
+* using the same metrics the Registers singleton uses, thus inspecting many
+* registers costs memory accesses rather than an ioctl apiece.
+* @note This class does not throw exceptions.
+*/
+class RegSnapshot
+{
+public:
+    RegSnapshot();
+    virtual ~RegSnapshot() {}
+
+    /// Has this object been populated by Registers::Snapshot()?
+    bool IsValid() const { return mValid; }
+
+    /**
+     * Decode a register from the snapshot.
+     * @param reg Pass which register to decode
+     * @param value Returns the value, if and only if successful. The
+     *          lowest order nibbles are populated 1st if the register is
+     *          smaller than sizeof(value)
+     * @return true upon success, false if the register is not part of this
+     *          snapshot or is larger than MAX_SUPPORTED_REG_SIZE
+     */
+    bool Get(PciSpc reg, uint64_t &value) const;
+    bool Get(CtlSpc reg, uint64_t &value) const;
+
+    /**
+     * Locate the raw bytes of a register within the snapshot, needed for
+     * those registers larger than MAX_SUPPORTED_REG_SIZE.
+     * @param reg Pass which register to locate
+     * @return NULL if the register is not part of this snapshot
+     */
+    const uint8_t *GetRaw(PciSpc reg) const;
+    const uint8_t *GetRaw(CtlSpc reg) const;
+
+    /**
+     * Compare this snapshot against a later one, reporting every register
+     * whose value changed. Identical spaces cost a single memcmp().
+     * @param after Pass the later snapshot
+     * @param delta Returns the registers which differ, in table order
+     */
+    void Diff(const RegSnapshot &after, vector<RegDelta> &delta) const;
+
+    /**
+     * Diff() this snapshot against a later one and log the result.
+     * @param after Pass the later snapshot
+     */
+    void LogDiff(const RegSnapshot &after) const;
+
+
+private:
+    friend class Registers;
+
+    bool mValid;
+    SpecRev mSpecRev;
+    const PciSpcType *mPciMetrics;
+    const CtlSpcType *mCtlMetrics;
+    /// Raw copy of PCI space and ctrlr space starting at offset 0
+    vector<uint8_t> mPci;
+    vector<uint8_t> mCtl;
+
+    const uint8_t *Locate(const vector<uint8_t> &space, uint16_t offset,
+        uint16_t size, SpecRev specRev) const;
+};
+
+
 /**
 * This class is meant to interface with PCI and/or ctrl'r registers.
 */
@@ -132,6 +210,17 @@ public:
     bool Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
         nvme_acc_type racc, uint8_t *value, bool verbose = true);
 
+    /**
+     * Bulk read all of PCI space, up to and including the last register of
+     * the discovered capabilities, and all of ctrlr space, excluding the
+     * doorbells. Each space costs a single ioctl regardless of the number
+     * of registers within, see class RegSnapshot to decode the result.
+     * @param snap Returns the snapshot, if and only if successful
+     * @param verbose Pass true to log action, false to be silent
+     * @return true upon success, otherwise false
+     */
+    bool Snapshot(RegSnapshot &snap, bool verbose = false);
+
     /**
      * Returns the list of capabilities discovered by parsing PCI address
      * space. This is is ordered in the fashion those capabilities were
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <boost/format.hpp>
+#include "aerService.h"
+#include "globals.h"
+
+/// The number of us the background thread sleeps while the ACQ is empty
+#define AER_POLL_US         100
+
+AERService *AERService::mActive = NULL;
+
+
+AsyncEventWaiter::AsyncEventWaiter()
+{
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+}
+
+
+AsyncEventWaiter::~AsyncEventWaiter()
+{
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+void
+AsyncEventWaiter::Update(AERService *subject, const AsyncEvent &event)
+{
+    subject = subject;      // Suppress compiler error/warning
+    pthread_mutex_lock(&mMutex);
+    mEvents.push_back(event);
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+}
+
+
+bool
+AsyncEventWaiter::Wait(uint32_t ms, AsyncEvent &event)
+{
+    struct timespec deadline;
+    int rc = 0;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (ms / 1000);
+    deadline.tv_nsec += ((ms % 1000) * 1000000);
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&mMutex);
+    while (mEvents.empty() && (rc != ETIMEDOUT))
+        rc = pthread_cond_timedwait(&mCond, &mMutex, &deadline);
+    bool found = (mEvents.empty() == false);
+    if (found) {
+        event = mEvents.front();
+        mEvents.pop_front();
+    }
+    pthread_mutex_unlock(&mMutex);
+    return found;
+}
+
+
+AERService::AERService() :
+    SubjectAsyncEvent(this),
+    mDispatcher("", "", SharedACQPtr(), 1)
+{
+    // This constructor will throw
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+AERService::AERService(string grpName, string testName, SharedASQPtr asq,
+    SharedACQPtr acq) :
+    SubjectAsyncEvent(this),
+    mDispatcher(grpName, testName, acq)
+{
+    mGrpName = grpName;
+    mTestName = testName;
+    mASQ = asq;
+    mACQ = acq;
+    mAERCmd = SharedAsyncEventReqPtr(new AsyncEventReq());
+    mNumEvents = 0;
+    mStarted = false;
+    mStop = 0;
+    mFailed = false;
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+}
+
+
+AERService::~AERService()
+{
+    // Never leave a thread running against an object about to be deleted
+    Stop();
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+
+void
+AERService::Start(uint32_t numAER)
+{
+    int rc;
+
+    if (mStarted)
+        throw FrmwkEx(HERE, "AER service is already running");
+    else if (mActive != NULL)
+        throw FrmwkEx(HERE, "Another AER service is already running");
+
+    if (numAER == 0) {
+        numAER = gInformative->GetIdentifyCmdCtrlr()->
+            GetValue(IDCTRLRCAP_AERL) + 1;  // convert to 1-based
+    }
+    // Per NVME spec: 1 empty CE implies a full CQ, leave room for 1 admin cmd
+    if ((numAER + 1) > (mACQ->GetNumEntries() - 1)) {
+        throw FrmwkEx(HERE, "ACQ holds %d CE's, too few for %d AER's",
+            mACQ->GetNumEntries(), numAER);
+    }
+
+    LOG_NRM("Keep %d async event req cmds outstanding", numAER);
+    pthread_mutex_lock(&mMutex);
+    try {
+        for (uint32_t i = 0; i < numAER; i++)
+            SendAER();
+    } catch (...) {
+        pthread_mutex_unlock(&mMutex);
+        throw;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    mNumEvents = 0;
+    mStop = 0;
+    mFailed = false;
+    if ((rc = pthread_create(&mThread, NULL, ServiceMain, this)) != 0)
+        throw FrmwkEx(HERE, "Unable to create AER service thread, rc=%d", rc);
+    mStarted = true;
+    mActive = this;
+}
+
+
+void
+AERService::Stop()
+{
+    if (mStarted == false)
+        return;
+
+    __sync_lock_test_and_set(&mStop, 1);
+    pthread_join(mThread, NULL);
+    mStarted = false;
+    mActive = NULL;
+    LOG_NRM("AER service stopped after %d async events", mNumEvents);
+}
+
+
+uint32_t
+AERService::GetNumEvents()
+{
+    pthread_mutex_lock(&mMutex);
+    uint32_t numEvents = mNumEvents;
+    pthread_mutex_unlock(&mMutex);
+    return numEvents;
+}
+
+
+bool
+AERService::GetFailure(string &failure)
+{
+    pthread_mutex_lock(&mMutex);
+    bool failed = mFailed;
+    if (failed)
+        failure = mFailure;
+    pthread_mutex_unlock(&mMutex);
+    return failed;
+}
+
+
+AERService *
+AERService::GetActive(SharedCQPtr cq)
+{
+    if ((mActive == NULL) || (cq->GetQId() != mActive->mACQ->GetQId()))
+        return NULL;
+    return mActive;
+}
+
+
+void
+AERService::SendAER()
+{
+    uint16_t uniqueId;
+
+    mASQ->Send(mAERCmd, uniqueId);
+    mDispatcher.Register(mASQ->GetQId(), uniqueId, &mAERListener);
+    mASQ->Ring();
+}
+
+
+CEStat
+AERService::SendAndReapCmd(uint16_t ms, SharedCmdPtr cmd, string qualify,
+    bool verbose, std::vector<CEStat> &status)
+{
+    struct timespec deadline;
+    uint16_t uniqueId;
+    CEFuture future;
+    string work;
+    int rc = 0;
+
+    if (status.empty()) {
+        throw FrmwkEx(HERE,
+            "Internal Programming Error; Must supply >= 1 status");
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (ms / 1000);
+    deadline.tv_nsec += ((ms % 1000) * 1000000);
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    // The cmd must be registered before its doorbell is rung, otherwise the
+    // background thread could reap its CE 1st.
+    pthread_mutex_lock(&mMutex);
+    try {
+        if (mFailed)
+            throw FrmwkEx(HERE, "AER service failed: %s", mFailure.c_str());
+
+        LOG_NRM("Send the cmd to hdw via SQ %d", mASQ->GetQId());
+        mASQ->Send(cmd, uniqueId);
+        if (verbose) {
+            work = str(boost::format(
+                "Just B4 ringing SQ %d doorbell, dump entire SQ") %
+                mASQ->GetQId());
+            mASQ->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
+                "sq." + cmd->GetName(), qualify), work);
+        }
+        mDispatcher.Register(mASQ->GetQId(), uniqueId, &future);
+        mASQ->Ring();
+    } catch (...) {
+        pthread_mutex_unlock(&mMutex);
+        throw;
+    }
+
+    LOG_NRM("Wait for the CE to arrive in CQ %d", mACQ->GetQId());
+    while ((future.IsDone() == false) && (mFailed == false) &&
+        (rc != ETIMEDOUT)) {
+        rc = pthread_cond_timedwait(&mCond, &mMutex, &deadline);
+    }
+    bool done = future.IsDone();
+    bool failed = mFailed;
+    pthread_mutex_unlock(&mMutex);
+
+    if (done == false) {
+        // The thread must never touch the future after it goes out of scope
+        Stop();
+        if (failed)
+            throw FrmwkEx(HERE, "AER service failed: %s", mFailure.c_str());
+        work = str(boost::format(
+            "Unable to see any CE's in CQ %d, dump entire CQ") %
+            mACQ->GetQId());
+        mACQ->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
+            "cq." + cmd->GetName(), qualify), work);
+        throw FrmwkEx(HERE, work);
+    }
+    if (verbose) {
+        cmd->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
+            cmd->GetName(), qualify), "A cmd's contents dumped");
+    }
+
+    // Search for 1 matching CEStat to match the device status
+    union CE ce = future.GetCE();
+    for (size_t sIdx = 0; sIdx < status.size(); sIdx++) {
+        if (ProcessCE::ValidatePeek(ce, status[sIdx]) == true)
+            return status[sIdx];
+    }
+    throw FrmwkEx(HERE,
+        "%d CeStat's compared to device status, but no match found",
+        status.size());
+}
+
+
+void *
+AERService::ServiceMain(void *arg)
+{
+    AERService *service = (AERService *)arg;
+
+    // Exceptions must not escape a thread, marshal them back to the waiters
+    try {
+        service->Service();
+    } catch (FrmwkEx &ex) {
+        pthread_mutex_lock(&service->mMutex);
+        service->mFailure = ex.GetMessage();
+        service->mFailed = true;
+        pthread_cond_broadcast(&service->mCond);
+        pthread_mutex_unlock(&service->mMutex);
+    } catch (...) {
+        pthread_mutex_lock(&service->mMutex);
+        service->mFailure = "Unknown exception";
+        service->mFailed = true;
+        pthread_cond_broadcast(&service->mCond);
+        pthread_mutex_unlock(&service->mMutex);
+    }
+    return NULL;
+}
+
+
+void
+AERService::Service()
+{
+    uint32_t numCE;
+    uint32_t isrCount;
+    vector<union CE> ces;
+    vector<union CE> events;
+    string failure;
+
+    while ((__sync_fetch_and_add(&mStop, 0) == 0) && failure.empty()) {
+        pthread_mutex_lock(&mMutex);
+        try {
+            if ((numCE = mACQ->ReapInquiry(isrCount)) != 0) {
+                mDispatcher.Dispatch(numCE);
+                ces.swap(mAERListener.ces);
+                mAERListener.ces.clear();
+
+                // Replace every AsyncEventReq which completed successfully.
+                // A failed one, i.e. the async event req limit was exceeded,
+                // would only fail again, so the service must end.
+                for (size_t i = 0; i < ces.size(); i++) {
+                    if (ProcessCE::ValidatePeek(ces[i]) == false) {
+                        if (failure.empty()) {
+                            failure = str(boost::format(
+                                "Async event req CID 0x%04X failed, "
+                                "(SCT:SC) = 0x%02X:0x%02X") %
+                                (uint16_t)ces[i].n.CID %
+                                (uint16_t)ces[i].n.SF.b.SCT %
+                                (uint16_t)ces[i].n.SF.b.SC);
+                        }
+                        continue;
+                    }
+                    events.push_back(ces[i]);
+                    if (failure.empty())
+                        SendAER();
+                }
+                mNumEvents += events.size();
+                pthread_cond_broadcast(&mCond);
+            }
+        } catch (...) {
+            pthread_mutex_unlock(&mMutex);
+            throw;
+        }
+        pthread_mutex_unlock(&mMutex);
+
+        // Observers are free to issue admin cmds, thus notify w/o the lock
+        for (size_t i = 0; i < events.size(); i++) {
+            AsyncEvent event;
+            event.ce = events[i];
+            event.type = events[i].n.async.asyncEventType;
+            event.info = events[i].n.async.asyncEventInfo;
+            event.logPage = events[i].n.async.assocLogPage;
+            LOG_NRM("Async event: (type,info,logPage) = (%d,%d,%d)",
+                event.type, event.info, event.logPage);
+            Notify(event);
+        }
+        if (ces.empty())
+            usleep(AER_POLL_US);
+        ces.clear();
+        events.clear();
+    }
+
+    // Marshaled to waiters and GetFailure() by ServiceMain()
+    if (failure.empty() == false) {
+        mACQ->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "acq.aer",
+            "fail"), failure);
+        throw FrmwkEx(HERE, failure);
+    }
+}
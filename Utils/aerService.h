@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _AERSERVICE_H_
+#define _AERSERVICE_H_
+
+#include <pthread.h>
+#include <string.h>
+#include <deque>
+#include "tnvme.h"
+#include "subject.h"
+#include "observer.h"
+#include "ceDispatcher.h"
+#include "../Queues/asq.h"
+#include "../Queues/acq.h"
+#include "../Cmds/asyncEventReq.h"
+
+class AERService;   // forward definition
+
+
+/**
+* The details of a single async event, as reported by the CE of an
+* AsyncEventReq cmd.
+*/
+struct AsyncEvent {
+    uint8_t type;           // see AsyncEventTypes
+    uint8_t info;           // see AsyncEventInfomation
+    uint8_t logPage;        // the log page to read to clear the event
+    union CE ce;
+
+    bool operator==(const AsyncEvent &other) const
+        { return (memcmp(&ce, &other.ce, sizeof(ce)) == 0); }
+};
+
+/// Subject/Observer pattern for async events delivered by an AERService
+typedef Observer<AERService, AsyncEvent> ObserverAsyncEvent;
+typedef Subject<AERService, AsyncEvent> SubjectAsyncEvent;
+
+
+/**
+* An ObserverAsyncEvent which allows a test to block until the next async
+* event is delivered.
+*/
+class AsyncEventWaiter : public ObserverAsyncEvent
+{
+public:
+    AsyncEventWaiter();
+    virtual ~AsyncEventWaiter();
+
+    virtual void Update(AERService *subject, const AsyncEvent &event);
+
+    /**
+     * Wait for, and consume, the oldest event not yet consumed.
+     * @param ms Pass the max number of ms to wait for an event to arrive
+     * @param event Returns the event
+     * @return true when an event was consumed, otherwise a timeout
+     */
+    bool Wait(uint32_t ms, AsyncEvent &event);
+
+
+private:
+    pthread_mutex_t mMutex;
+    pthread_cond_t mCond;
+    deque<AsyncEvent> mEvents;
+};
+
+
+/**
+* This class keeps a number of AsyncEventReq cmds outstanding within the ASQ
+* for as long as it is running, and demultiplexes every CE arriving in the ACQ
+* from a background thread. The CE's of AsyncEventReq cmds are delivered to
+* the attached ObserverAsyncEvent's, whereupon another AsyncEventReq is issued
+* in its place. An AsyncEventReq completing w/ an error status isn't delivered
+* nor reissued, rather the service fails, see GetFailure(). All other CE's are
+* routed to the admin cmd awaiting them, thus admin cmds may be issued while
+* async events are outstanding. Whilst running, IO::SendAndReapCmd()
+* targeting the ACQ is transparently routed through SendAndReapCmd() of this
+* class, rather than demanding an empty ACQ.
+*
+* Observers must be attached before Start() and are notified from the
+* background thread. Stop() must be called before the ctrlr is disabled;
+* the AsyncEventReq cmds left outstanding are only aborted by a ctrlr reset.
+*
+* @note This class may throw exceptions.
+*/
+class AERService : public SubjectAsyncEvent
+{
+public:
+    /**
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param asq Pass the ASQ to issue all admin cmds into
+     * @param acq Pass the ACQ to reap all admin CE's from
+     */
+    AERService(string grpName, string testName, SharedASQPtr asq,
+        SharedACQPtr acq);
+    virtual ~AERService();
+
+    /**
+     * Issue the AsyncEventReq cmds and launch the background thread. Only a
+     * single instance may be running at any one time.
+     * @param numAER Pass the number of AsyncEventReq cmds to keep outstanding;
+     *      0 indicates Identify.AERL worth of them.
+     */
+    void Start(uint32_t numAER = 0);
+
+    /// Stop the background thread, the AsyncEventReq cmds remain outstanding
+    void Stop();
+
+    /// @return The number of async events delivered since Start()
+    uint32_t GetNumEvents();
+
+    /**
+     * The background thread ends upon any error, i.e. an AsyncEventReq cmd
+     * completing w/ an error status, which is never reissued.
+     * @param failure Returns the reason the service failed, if it has
+     * @return true if the background thread has failed, otherwise false
+     */
+    bool GetFailure(string &failure);
+
+    /**
+     * Send a single admin cmd and wait for the background thread to deliver
+     * its CE, see IO::SendAndReapCmd() for details.
+     * @note Throws upon errors, including a failure of the background thread
+     * @param ms Pass the max number of ms to wait for the CE to arrive
+     * @param cmd Pass the cmd to send
+     * @param qualify Pass a qualifying string to append to each dump file
+     * @param verbose Pass true to dump the ASQ and cmd
+     * @param status Pass the CE status values, any of which is acceptable
+     * @return The CE status which matched
+     */
+    CEStat SendAndReapCmd(uint16_t ms, SharedCmdPtr cmd, string qualify,
+        bool verbose, std::vector<CEStat> &status);
+
+    /**
+     * @param cq Pass the CQ to inquire about
+     * @return The running instance reaping the CQ, otherwise NULL
+     */
+    static AERService *GetActive(SharedCQPtr cq);
+
+
+private:
+    AERService();
+
+    /// Records the CE's of AsyncEventReq cmds while dispatching
+    class AERListener : public CEListener
+    {
+    public:
+        vector<union CE> ces;
+        virtual void Completed(const union CE &ce) { ces.push_back(ce); }
+    };
+
+    string mGrpName;
+    string mTestName;
+    SharedASQPtr mASQ;
+    SharedACQPtr mACQ;
+    SharedAsyncEventReqPtr mAERCmd;
+    /// Only ever accessed while holding mMutex
+    CEDispatcher mDispatcher;
+    AERListener mAERListener;
+    uint32_t mNumEvents;
+
+    pthread_mutex_t mMutex;
+    /// Broadcast whenever CE's have been dispatched or the thread failed
+    pthread_cond_t mCond;
+    pthread_t mThread;
+    bool mStarted;
+    volatile int mStop;
+    bool mFailed;
+    string mFailure;
+
+    static AERService *mActive;
+
+    /// Send an AsyncEventReq, mMutex must be held
+    void SendAER();
+
+    /// The entry point of the background thread
+    static void *ServiceMain(void *arg);
+    void Service();
+};
+
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "bufferPool.h"
+#include "globals.h"
+
+static pthread_mutex_t gPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+BufferPool::BufferPool()
+{
+}
+
+
+BufferPool::~BufferPool()
+{
+}
+
+
+BufferPool::Pool *
+BufferPool::GetPool()
+{
+    static Pool *pool = NULL;
+
+    if (pool == NULL) {
+        pool = new Pool();
+        for (uint32_t i = 0; i < BUFPOOL_NUM_CLASSES; i++) {
+            pool->classes[i].numAllocs = 0;
+            pool->classes[i].numCarved = 0;
+            pool->classes[i].inUse = 0;
+            pool->classes[i].highWater = 0;
+        }
+        pool->bytesInUse = 0;
+        pool->bytesHighWater = 0;
+        pool->bytesReserved = 0;
+        pool->numUnpooled = 0;
+    }
+    return pool;
+}
+
+
+uint32_t
+BufferPool::GetClass(uint32_t size, uint32_t align)
+{
+    uint32_t shift = BUFPOOL_MIN_CLASS_SHIFT;
+    uint32_t pgSize = sysconf(_SC_PAGESIZE);
+
+    if ((size > (1U << BUFPOOL_MAX_CLASS_SHIFT)) || (align > pgSize))
+        return BUFPOOL_NUM_CLASSES;
+
+    // A class is naturally aligned to its own size, up to a page
+    while (((1U << shift) < size) || ((1U << shift) < align))
+        shift++;
+    if (shift > BUFPOOL_MAX_CLASS_SHIFT)
+        return BUFPOOL_NUM_CLASSES;
+    return (shift - BUFPOOL_MIN_CLASS_SHIFT);
+}
+
+
+void
+BufferPool::Carve(Pool *pool, uint32_t classIdx)
+{
+    uint8_t *slab = NULL;
+    uint32_t pgSize = sysconf(_SC_PAGESIZE);
+    uint32_t bufSize = (1U << (classIdx + BUFPOOL_MIN_CLASS_SHIFT));
+    uint32_t slabSize = MAX(bufSize, pgSize);
+    SizeClass &sc = pool->classes[classIdx];
+
+    // Classes of a page and larger prefer hugepage arenas, keeping large
+    // payloads physically contiguous and off the TLB's back.
+    if (bufSize >= pgSize) {
+        for (size_t i = 0; i < pool->arenas.size(); i++) {
+            Arena &arena = pool->arenas[i];
+            uint64_t start = ((arena.used + bufSize - 1) / bufSize) * bufSize;
+            if ((start + bufSize) <= arena.size) {
+                arena.used = (start + bufSize);
+                sc.freeList.push_back(arena.base + start);
+                sc.numCarved++;
+                return;
+            }
+        }
+    }
+
+    int err = posix_memalign((void **)&slab, pgSize, slabSize);
+    if (err) {
+        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
+            err);
+    }
+    pool->bytesReserved += slabSize;
+
+    // Sub-page classes are carved many to a page
+    for (uint32_t offset = 0; offset < slabSize; offset += bufSize) {
+        sc.freeList.push_back(slab + offset);
+        sc.numCarved++;
+    }
+}
+
+
+uint8_t *
+BufferPool::Alloc(uint32_t size, uint32_t align)
+{
+    uint8_t *buf = NULL;
+    uint32_t classIdx = GetClass(size, align);
+
+    if (classIdx >= BUFPOOL_NUM_CLASSES) {
+        int err = posix_memalign((void **)&buf, MAX(align, sizeof(void *)),
+            size);
+        if (err) {
+            throw FrmwkEx(HERE,
+                "Memory allocation failed with error code: 0x%02X", err);
+        }
+        pthread_mutex_lock(&gPoolMutex);
+        GetPool()->numUnpooled++;
+        pthread_mutex_unlock(&gPoolMutex);
+        return buf;
+    }
+
+    pthread_mutex_lock(&gPoolMutex);
+    Pool *pool = GetPool();
+    SizeClass &sc = pool->classes[classIdx];
+    try {
+        if (sc.freeList.empty())
+            Carve(pool, classIdx);
+    } catch (...) {
+        pthread_mutex_unlock(&gPoolMutex);
+        throw;
+    }
+
+    // LIFO; the most recently freed buffer is the most likely to be cached
+    buf = sc.freeList.back();
+    sc.freeList.pop_back();
+    sc.numAllocs++;
+    sc.inUse++;
+    sc.highWater = MAX(sc.highWater, sc.inUse);
+    pool->bytesInUse += (1ULL << (classIdx + BUFPOOL_MIN_CLASS_SHIFT));
+    pool->bytesHighWater = MAX(pool->bytesHighWater, pool->bytesInUse);
+    pthread_mutex_unlock(&gPoolMutex);
+    return buf;
+}
+
+
+void
+BufferPool::Free(uint8_t *buf, uint32_t size, uint32_t align)
+{
+    if (buf == NULL)
+        return;
+
+    uint32_t classIdx = GetClass(size, align);
+    if (classIdx >= BUFPOOL_NUM_CLASSES) {
+        free(buf);
+        return;
+    }
+
+    pthread_mutex_lock(&gPoolMutex);
+    Pool *pool = GetPool();
+    SizeClass &sc = pool->classes[classIdx];
+    sc.freeList.push_back(buf);
+    sc.inUse--;
+    pool->bytesInUse -= (1ULL << (classIdx + BUFPOOL_MIN_CLASS_SHIFT));
+    pthread_mutex_unlock(&gPoolMutex);
+}
+
+
+bool
+BufferPool::AddHugePageArena(uint64_t size)
+{
+    Arena arena;
+
+    arena.size = (((size + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE) * HUGEPAGE_SIZE);
+    arena.used = 0;
+    arena.base = (uint8_t *)mmap(NULL, arena.size, (PROT_READ | PROT_WRITE),
+        (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE), -1, 0);
+    if (arena.base == MAP_FAILED) {
+        LOG_WARN("Unable to reserve 0x%llX bytes of hugepages: %s",
+            (long long unsigned int)arena.size, strerror(errno));
+        return false;
+    }
+    if (mlock(arena.base, arena.size) != 0)
+        LOG_WARN("Unable to mlock hugepage arena: %s", strerror(errno));
+
+    LOG_NRM("Reserved hugepage arena of 0x%llX bytes",
+        (long long unsigned int)arena.size);
+    pthread_mutex_lock(&gPoolMutex);
+    Pool *pool = GetPool();
+    pool->arenas.push_back(arena);
+    pool->bytesReserved += arena.size;
+    pthread_mutex_unlock(&gPoolMutex);
+    return true;
+}
+
+
+bool
+BufferPool::IsHugePage(const uint8_t *buf)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&gPoolMutex);
+    Pool *pool = GetPool();
+    for (size_t i = 0; (found == false) && (i < pool->arenas.size()); i++) {
+        Arena &arena = pool->arenas[i];
+        found = ((buf >= arena.base) && (buf < (arena.base + arena.size)));
+    }
+    pthread_mutex_unlock(&gPoolMutex);
+    return found;
+}
+
+
+void
+BufferPool::LogStats()
+{
+    pthread_mutex_lock(&gPoolMutex);
+    Pool *pool = GetPool();
+
+    LOG_NRM("Buffer pool: in use 0x%llX bytes, high-water 0x%llX bytes, "
+        "reserved 0x%llX bytes, unpooled allocs %llu",
+        (long long unsigned int)pool->bytesInUse,
+        (long long unsigned int)pool->bytesHighWater,
+        (long long unsigned int)pool->bytesReserved,
+        (long long unsigned int)pool->numUnpooled);
+    for (uint32_t i = 0; i < BUFPOOL_NUM_CLASSES; i++) {
+        SizeClass &sc = pool->classes[i];
+        if (sc.numAllocs == 0)
+            continue;
+        LOG_NRM("  class 0x%08X: allocs %llu, created %llu, in use %llu, "
+            "high-water %llu, free %lu", (1U << (i + BUFPOOL_MIN_CLASS_SHIFT)),
+            (long long unsigned int)sc.numAllocs,
+            (long long unsigned int)sc.numCarved,
+            (long long unsigned int)sc.inUse,
+            (long long unsigned int)sc.highWater,
+            (long unsigned int)sc.freeList.size());
+    }
+    pthread_mutex_unlock(&gPoolMutex);
+}
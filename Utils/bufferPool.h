@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _BUFFERPOOL_H_
+#define _BUFFERPOOL_H_
+
+#include <sys/mman.h>
+#include "tnvme.h"
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB                 0x40000
+#endif
+
+#define HUGEPAGE_SIZE               (2 * 1024 * 1024)
+
+/// Buffers are pooled in power of 2 size classes between these limits
+#define BUFPOOL_MIN_CLASS_SHIFT     6       // 64B
+#define BUFPOOL_MAX_CLASS_SHIFT     21      // 2MB, i.e. HUGEPAGE_SIZE
+#define BUFPOOL_NUM_CLASSES         \
+    (BUFPOOL_MAX_CLASS_SHIFT - BUFPOOL_MIN_CLASS_SHIFT + 1)
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It is a size class slab pool from which MemBuffer draws its
+* memory, and to which it returns that memory when re-initialized or
+* destroyed. Every buffer is naturally aligned to its power of 2 size class,
+* up to a page. Sub-page classes are carved from whole pages, while larger
+* classes are taken from hugepage arenas, when any were added, or else from
+* the heap. Memory is never handed back to the OS; freed buffers are kept on a
+* per class free list, thus a test loop re-initializing buffers of the same
+* size stops allocating, and page faulting, after its 1st iteration.
+* Requests larger than the largest class, a hugepage, or needing more than
+* page alignment, bypass the pool. Such rare, large buffers are returned to
+* the OS when freed, rather than being rounded up to a power of 2 and held.
+*
+* @note This class may throw exceptions.
+*/
+class BufferPool
+{
+public:
+    /**
+     * Take a buffer from the pool.
+     * @param size Pass the number of bytes required
+     * @param align Pass the alignment required, a power of 2
+     * @return The buffer, which must be returned via Free() passing identical
+     *      size and align parameters.
+     */
+    static uint8_t *Alloc(uint32_t size, uint32_t align);
+
+    /**
+     * Return a buffer to the pool.
+     * @param buf Pass the buffer returned by Alloc()
+     * @param size Pass the size which was passed to Alloc()
+     * @param align Pass the alignment which was passed to Alloc()
+     */
+    static void Free(uint8_t *buf, uint32_t size, uint32_t align);
+
+    /**
+     * Reserve an arena of hugepages for classes of a page and larger to be
+     * carved from. The arena is populated and mlock'd up front. Failing to
+     * reserve hugepages is not an error, the heap is used instead.
+     * @param size Pass the number of bytes to reserve, rounded up to a whole
+     *      number of hugepages.
+     * @return true if the arena was reserved, otherwise false
+     */
+    static bool AddHugePageArena(uint64_t size);
+
+    /**
+     * @param buf Pass any buffer returned by Alloc()
+     * @return true if the buffer was carved from a hugepage arena
+     */
+    static bool IsHugePage(const uint8_t *buf);
+
+    /// Log the usage and high-water mark of every size class ever used
+    static void LogStats();
+
+
+private:
+    BufferPool();
+    virtual ~BufferPool();
+
+    struct SizeClass {
+        vector<uint8_t *> freeList;
+        uint64_t numAllocs;         // Alloc()'s satisfied by this class
+        uint64_t numCarved;         // buffers ever created for this class
+        uint64_t inUse;
+        uint64_t highWater;         // max of inUse
+    };
+
+    struct Arena {
+        uint8_t *base;
+        uint64_t size;
+        uint64_t used;
+    };
+
+    struct Pool {
+        SizeClass classes[BUFPOOL_NUM_CLASSES];
+        vector<Arena> arenas;
+        uint64_t bytesInUse;
+        uint64_t bytesHighWater;
+        uint64_t bytesReserved;     // memory held by the pool
+        uint64_t numUnpooled;       // Alloc()'s which bypassed the pool
+    };
+
+    /// Never destroyed; MemBuffer's may outlive any static destructor
+    static Pool *GetPool();
+
+    /**
+     * @return The index of the size class which satisfies a request, or
+     *      BUFPOOL_NUM_CLASSES if the request must bypass the pool.
+     */
+    static uint32_t GetClass(uint32_t size, uint32_t align);
+
+    /// Create buffers for a size class, appending them to its free list
+    static void Carve(Pool *pool, uint32_t classIdx);
+};
+
+
+#endif
@@ -14,8 +14,27 @@
  *  limitations under the License.
  */
 
+#include <zlib.h>
 #include "buffers.h"
 #include "globals.h"
+#include "deferredDump.h"
+
+/// Each row dumps this many bytes, formatted as "0xOOOOOOOO: XX XX .. XX\n"
+#define HEX_BYTES_PER_ROW       16
+#define HEX_ROW_MAX_CHARS       (12 + (HEX_BYTES_PER_ROW * 3) + 1)
+/// Dumps are written in chunks of this size
+#define HEX_OUT_BUF_SIZE        (256 * 1024)
+
+/// The 2 hex digits representing byte value x begin at offset (x * 2)
+static const char gHexPairs[] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
 
 
 Buffers::Buffers()
@@ -33,9 +52,7 @@ Buffers::Log(const uint8_t *buf, uint32_t bufOffset, unsigned long length,
     uint32_t totalBufSize, string objName)
 {
     const uint8_t *data;
-    const int BUF_SIZE = 20;
-    char work[BUF_SIZE];
-    string output;
+    char row[HEX_ROW_MAX_CHARS];
     unsigned long dumpLen = length;
 
 
@@ -52,22 +69,12 @@ Buffers::Log(const uint8_t *buf, uint32_t bufOffset, unsigned long length,
         dumpLen = (totalBufSize - bufOffset);
     LOG_DBG("dumpLen = 0x%016lX", dumpLen);
 
-    for (unsigned long i = 0; i < dumpLen; i++) {
-        if ((i % 16) == 15) {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
-            LOG_NRM("%s", output.c_str());
-            output.clear();
-        } else if ((i % 16) == 0) {
-            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
-            output += work;
-        } else {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
-        }
+    for (unsigned long i = 0; i < dumpLen; i += HEX_BYTES_PER_ROW) {
+        size_t rowLen = FormatHexRow(row, i, (data + i),
+            MIN(HEX_BYTES_PER_ROW, (dumpLen - i)));
+        row[rowLen - 1] = '\0';    // LOG_NRM() terminates the line
+        LOG_NRM("%s", row);
     }
-    if (output.length() != 0)
-        LOG_NRM("%s", output.c_str());
 }
 
 
@@ -75,58 +82,112 @@ void
 Buffers::Dump(DumpFilename filename, const uint8_t *buf, uint32_t bufOffset,
     unsigned long length, uint32_t totalBufSize, string fileHdr)
 {
-    const uint8_t *data;
-    const int BUF_SIZE = 20;
-    char work[BUF_SIZE];
-    string output;
-    FILE *fp;
     unsigned long dumpLen = length;
 
 
     LOG_NRM("Dumping to filename: %s", filename.c_str());
     LOG_NRM("%s", fileHdr.c_str());
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
-    fprintf(fp, "%s\n", fileHdr.c_str());
-
     if (totalBufSize == 0) {
-        fprintf(fp, "0x00000000: BUFFER IS EMPTY\n");
-        goto Dump_EXIT_SUCCESS;
+        DeferredDump::Capture(filename, RenderHex, NULL, 0, true, fileHdr);
+        return;
     } else if (bufOffset >= totalBufSize) {
+        DeferredDump::Capture(filename, RenderHex, NULL, 0, false, fileHdr);
         LOG_ERR("Offset into buffer 0x%08X >= to buffer size 0x%08X",
             bufOffset, totalBufSize);
-        goto Dump_EXIT_ERROR;
+        throw FrmwkEx(HERE);
     }
 
-    data = &(buf[bufOffset]);
     if (length == ULONG_MAX)
         dumpLen = (totalBufSize - bufOffset);
     else if ((length + bufOffset) >= totalBufSize)
         dumpLen = (totalBufSize - bufOffset);
     LOG_DBG("dumpLen = 0x%016lX", dumpLen);
 
-    for (unsigned long i = 0; i < dumpLen; i++) {
-        if ((i % 16) == 15) {
-            snprintf(work, BUF_SIZE, " %02X\n", *data++);
-            output += work;
-            fprintf(fp, "%s", output.c_str());
-            output.clear();
-        } else if ((i % 16) == 0) {
-            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
-            output += work;
-        } else {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
+    // Only the raw bytes are snapshot while dumps are deferred
+    if (gCmdLine.dumpGz && (dumpLen >= (gCmdLine.dumpGz * 1024UL))) {
+        DeferredDump::Capture(filename, RenderHexGz, &(buf[bufOffset]),
+            dumpLen, false, fileHdr);
+    } else {
+        DeferredDump::Capture(filename, RenderHex, &(buf[bufOffset]), dumpLen,
+            false, fileHdr);
+    }
+}
+
+
+size_t
+Buffers::FormatHexRow(char *row, uint32_t offset, const uint8_t *data,
+    uint32_t numBytes)
+{
+    static const char hexDigit[] = "0123456789ABCDEF";
+    char *out = row;
+
+    *out++ = '0';
+    *out++ = 'x';
+    for (int shift = 28; shift >= 0; shift -= 4)
+        *out++ = hexDigit[(offset >> shift) & 0xf];
+    *out++ = ':';
+    for (uint32_t i = 0; i < numBytes; i++) {
+        const char *pair = &gHexPairs[data[i] * 2];
+        *out++ = ' ';
+        *out++ = pair[0];
+        *out++ = pair[1];
+    }
+    *out++ = '\n';
+    return (out - row);
+}
+
+
+void
+Buffers::RenderHex(FILE *fp, DumpFilename, const uint8_t *data,
+    size_t dumpLen, uint32_t empty, const string &fileHdr)
+{
+    fprintf(fp, "%s\n", fileHdr.c_str());
+    if (empty) {
+        fprintf(fp, "0x00000000: BUFFER IS EMPTY\n");
+        return;
+    }
+
+    // Whole rows are encoded into a large buffer, written by 1 fwrite()
+    vector<char> out(MIN((((dumpLen / HEX_BYTES_PER_ROW) + 1) *
+        HEX_ROW_MAX_CHARS), HEX_OUT_BUF_SIZE));
+    size_t outLen = 0;
+    for (unsigned long i = 0; i < dumpLen; i += HEX_BYTES_PER_ROW) {
+        if ((outLen + HEX_ROW_MAX_CHARS) > out.size()) {
+            fwrite(&out[0], 1, outLen, fp);
+            outLen = 0;
         }
+        outLen += FormatHexRow((&out[0] + outLen), i, (data + i),
+            MIN(HEX_BYTES_PER_ROW, (dumpLen - i)));
     }
-    if (output.length() != 0)
-        fprintf(fp, "%s\n", output.c_str());
+    if (outLen)
+        fwrite(&out[0], 1, outLen, fp);
+}
 
-Dump_EXIT_SUCCESS:
-    fclose(fp);
-    return;
 
-Dump_EXIT_ERROR:
-    fclose(fp);
-    throw FrmwkEx(HERE);
+void
+Buffers::RenderHexGz(FILE *fp, DumpFilename filename, const uint8_t *data,
+    size_t dumpLen, uint32_t, const string &fileHdr)
+{
+    gzFile gz;
+    string gzName = (filename + ".gz");
+    char row[HEX_ROW_MAX_CHARS];
+
+    // gzip members may be concatenated, appending keeps every dump
+    if ((gz = gzopen(gzName.c_str(), "ab")) == NULL) {
+        LOG_ERR("Failed to open file: %s, dumping uncompressed",
+            gzName.c_str());
+        RenderHex(fp, filename, data, dumpLen, false, fileHdr);
+        return;
+    }
+    fprintf(fp, "%s\n", fileHdr.c_str());
+    fprintf(fp, "0x%08lX bytes dumped compressed to: %s\n", dumpLen,
+        gzName.c_str());
+
+    gzprintf(gz, "%s\n", fileHdr.c_str());
+    for (unsigned long i = 0; i < dumpLen; i += HEX_BYTES_PER_ROW) {
+        size_t rowLen = FormatHexRow(row, i, (data + i),
+            MIN(HEX_BYTES_PER_ROW, (dumpLen - i)));
+        gzwrite(gz, row, rowLen);
+    }
+    gzclose(gz);
 }
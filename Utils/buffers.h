@@ -54,6 +54,8 @@ public:
     /**
      * Send the entire contents of this buf starting a bufOffset and continue
      * for length bytes to the file named by filename. The file is appended.
+     * While dumps are deferred only the raw bytes are snapshot, see class
+     * DeferredDump.
      * @note This method may throw
      * @param filename Pass the name of a file to open for dumping buffer
      * @param buf Pass a pointer to the buffer to dump
@@ -65,6 +67,27 @@ public:
     static void Dump(DumpFilename filename, const uint8_t *buf,
         uint32_t bufOffset, unsigned long length, uint32_t totalBufSize,
         string fileHdr);
+
+    /// DumpRenderFn writing fileHdr and a hex dump of data, see DeferredDump
+    static void RenderHex(FILE *fp, DumpFilename filename, const uint8_t *data,
+        size_t dumpLen, uint32_t empty, const string &fileHdr);
+
+
+private:
+    /**
+     * Format 1 row of a hex dump, terminated by '\n' but not by '\0'.
+     * @param row Pass the output, at least HEX_ROW_MAX_CHARS in size
+     * @param offset Pass the offset of the row's 1st byte to print
+     * @param data Pass the bytes of the row
+     * @param numBytes Pass the number of bytes in the row, max of 16
+     * @return The number of chars formatted
+     */
+    static size_t FormatHexRow(char *row, uint32_t offset, const uint8_t *data,
+        uint32_t numBytes);
+
+    /// DumpRenderFn as RenderHex(), but to the gzip file <filename>.gz
+    static void RenderHexGz(FILE *fp, DumpFilename filename,
+        const uint8_t *data, size_t dumpLen, uint32_t, const string &fileHdr);
 };
 
 
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/format.hpp>
+#include "ceDispatcher.h"
+#include "globals.h"
+
+
+CEDispatcher::CEDispatcher()
+{
+    // This constructor will throw
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+CEDispatcher::CEDispatcher(string grpName, string testName, SharedCQPtr cq,
+    uint32_t maxPending)
+{
+    mGrpName = grpName;
+    mTestName = testName;
+    mCQ = cq;
+    mNumPending = 0;
+
+    // Per NVME spec: 1 empty CE implies a full CQ, can't truly fill all
+    mMaxPending = (maxPending ? maxPending : (cq->GetNumEntries() - 1));
+
+    uint32_t tableSize = 16;
+    mShift = 28;
+    while (tableSize < (mMaxPending * 2)) {
+        tableSize <<= 1;
+        mShift--;
+    }
+    mMask = (tableSize - 1);
+
+    Entry empty = { 0, NULL };
+    mTable.assign(tableSize, empty);
+}
+
+
+CEDispatcher::~CEDispatcher()
+{
+    if (mNumPending) {
+        LOG_WARN("Destroying CQ %d dispatcher with %d cmds pending",
+            mCQ->GetQId(), mNumPending);
+    }
+}
+
+
+void
+CEDispatcher::Register(uint16_t sqId, uint16_t cid, CEListener *listener)
+{
+    if (listener == NULL)
+        throw FrmwkEx(HERE, "A listener must be supplied");
+    else if (mNumPending >= mMaxPending)
+        throw FrmwkEx(HERE, "Registered cmds would exceed %d", mMaxPending);
+
+    uint32_t key = MakeKey(sqId, cid);
+    uint32_t idx = Hash(key);
+    while (mTable[idx].listener != NULL) {
+        if (mTable[idx].key == key) {
+            throw FrmwkEx(HERE, "Cmd (SQID:CID) 0x%04X:0x%04X is already "
+                "pending in CQ %d", sqId, cid, mCQ->GetQId());
+        }
+        idx = ((idx + 1) & mMask);
+    }
+    mTable[idx].key = key;
+    mTable[idx].listener = listener;
+    mNumPending++;
+}
+
+
+CEListener *
+CEDispatcher::Remove(uint32_t key)
+{
+    uint32_t idx = Hash(key);
+    while (mTable[idx].listener != NULL) {
+        if (mTable[idx].key == key)
+            break;
+        idx = ((idx + 1) & mMask);
+    }
+    CEListener *listener = mTable[idx].listener;
+    if (listener == NULL)
+        return NULL;
+
+    // Linear probing deletion; shift back any subsequent entry of the same
+    // probe sequence into the hole, thus no tombstones are ever required.
+    uint32_t hole = idx;
+    uint32_t next = ((idx + 1) & mMask);
+    while (mTable[next].listener != NULL) {
+        uint32_t home = Hash(mTable[next].key);
+        if (((next - home) & mMask) >= ((next - hole) & mMask)) {
+            mTable[hole] = mTable[next];
+            hole = next;
+        }
+        next = ((next + 1) & mMask);
+    }
+    mTable[hole].listener = NULL;
+    mNumPending--;
+    return listener;
+}
+
+
+uint32_t
+CEDispatcher::Dispatch(uint32_t ceDesire)
+{
+    uint32_t ceRemain;
+    uint32_t isrCount;
+    string work;
+
+    CESpan ces = mCQ->ReapToScratch(ceRemain, isrCount, ceDesire);
+    for (uint32_t i = 0; i < ces.size(); i++) {
+        union CE ce = ces[i];
+        CEListener *listener = Remove(MakeKey(ce.n.SQID, ce.n.CID));
+        if (listener == NULL) {
+            work = str(boost::format(
+                "CE for unknown cmd (SQID:CID) 0x%04X:0x%04X in CQ %d, "
+                "dump entire CQ") % (uint16_t)ce.n.SQID % (uint16_t)ce.n.CID %
+                mCQ->GetQId());
+            mCQ->Dump(FileSystem::PrepDumpFile(mGrpName, mTestName,
+                "cq.dispatch"), work);
+            throw FrmwkEx(HERE, work);
+        }
+        listener->Completed(ce);
+    }
+    return ces.size();
+}
+
+
+bool
+CEDispatcher::DispatchAll(uint16_t ms)
+{
+    uint32_t numCE;
+    uint32_t isrCount;
+
+    while (mNumPending) {
+        if (mCQ->ReapInquiryWaitAny(ms, numCE, isrCount) == false) {
+            LOG_ERR("%d cmds never completed into CQ %d", mNumPending,
+                mCQ->GetQId());
+            return false;
+        }
+        Dispatch(numCE);
+    }
+    return true;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _CEDISPATCHER_H_
+#define _CEDISPATCHER_H_
+
+#include <string.h>
+#include "tnvme.h"
+#include "fileSystem.h"
+#include "../Queues/cq.h"
+
+
+/**
+* Receives the CE which completed a cmd registered with a CEDispatcher.
+*/
+class CEListener
+{
+public:
+    virtual ~CEListener() {}
+
+    /**
+     * Notification that the registered cmd has completed.
+     * @param ce Pass the CE which completed the cmd; it is only valid for
+     *      the duration of this call.
+     */
+    virtual void Completed(const union CE &ce) = 0;
+};
+
+
+/**
+* A CEListener which simply remembers the CE for later inspection.
+*/
+class CEFuture : public CEListener
+{
+public:
+    CEFuture() : mDone(false) { memset(&mCE, 0, sizeof(mCE)); }
+    virtual ~CEFuture() {}
+
+    virtual void Completed(const union CE &ce) { mCE = ce; mDone = true; }
+
+    bool IsDone() const { return mDone; }
+    /// @return The CE which completed the cmd, only valid if IsDone()
+    union CE GetCE() const { return mCE; }
+
+
+private:
+    bool mDone;
+    union CE mCE;
+};
+
+
+/**
+* This class reaps all the CE's arriving in a single CQ and routes each of them
+* to the CEListener registered against the (SQID, CID) of the cmd it completes.
+* Cmds fed from any number of SQ's associated with the CQ may therefore be
+* outstanding simultaneously and complete in any order. Registrations are held
+* within a fixed size, open addressed hash table, thus neither registering nor
+* dispatching allocates memory.
+*
+* @note This class may throw exceptions.
+*/
+class CEDispatcher
+{
+public:
+    /**
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param cq Pass the CQ to reap CE's from
+     * @param maxPending Pass the max number of cmds which will be registered
+     *      at any one time; 0 indicates what the CQ can hold.
+     */
+    CEDispatcher(string grpName, string testName, SharedCQPtr cq,
+        uint32_t maxPending = 0);
+    virtual ~CEDispatcher();
+
+    /**
+     * Register interest in the completion of a cmd which was just sent.
+     * @param sqId Pass the ID of the SQ the cmd was sent to
+     * @param cid Pass the CID dnvme assigned the cmd during SQ::Send()
+     * @param listener Pass the object to notify upon completion; it must
+     *      outlive the cmd's completion.
+     */
+    void Register(uint16_t sqId, uint16_t cid, CEListener *listener);
+
+    /// @return The number of registered cmds which have not yet completed
+    uint32_t GetNumPending() { return mNumPending; }
+
+    /**
+     * Reap whatever CE's are present in the CQ, without waiting, and notify
+     * the listener of each. A CE matching no registration causes the CQ to be
+     * dumped and an exception to be thrown.
+     * @param ceDesire Pass the max number of CE's to reap, 0 indicates reap
+     *      all which can be reaped.
+     * @return The number of CE's dispatched
+     */
+    uint32_t Dispatch(uint32_t ceDesire = 0);
+
+    /**
+     * Dispatch CE's until all registered cmds have completed.
+     * @param ms Pass the max number of ms to wait for each CE to arrive
+     * @return true when all registered cmds completed, otherwise a timeout
+     */
+    bool DispatchAll(uint16_t ms);
+
+
+private:
+    CEDispatcher();
+
+    struct Entry {
+        uint32_t key;               // (SQID << 16) | CID
+        CEListener *listener;       // NULL indicates an empty slot
+    };
+
+    string mGrpName;
+    string mTestName;
+    SharedCQPtr mCQ;
+    uint32_t mMaxPending;
+    uint32_t mNumPending;
+    /// Power of 2 sized, at least twice mMaxPending to keep probes short
+    vector<Entry> mTable;
+    uint32_t mMask;
+    uint32_t mShift;
+
+    static uint32_t MakeKey(uint16_t sqId, uint16_t cid)
+        { return (((uint32_t)sqId << 16) | cid); }
+    /// Fibonacci hashing; the upper bits of the product are the best mixed
+    uint32_t Hash(uint32_t key) const
+        { return ((key * 0x9E3779B1U) >> mShift); }
+
+    /**
+     * Remove a registration from the table.
+     * @param key Pass the key of the registration to remove
+     * @return The registered listener, NULL if there was no registration
+     */
+    CEListener *Remove(uint32_t key);
+};
+
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <time.h>
+#include "cmdLatency.h"
+
+vector<CmdLatency::SQStamps *> CmdLatency::mSQ;
+
+
+CmdLatency::CmdLatency()
+{
+}
+
+
+CmdLatency::~CmdLatency()
+{
+}
+
+
+uint64_t
+CmdLatency::Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec);
+}
+
+
+void
+CmdLatency::InitSQ(uint16_t sqId, uint32_t numEntries)
+{
+    if (sqId >= mSQ.size())
+        mSQ.resize(sqId + 1, NULL);
+    if (mSQ[sqId] == NULL)
+        mSQ[sqId] = new SQStamps();
+
+    // An SQ never holds more than (numEntries - 1) cmds, however the CID's
+    // of outstanding cmds need not be consecutive; twice the size makes
+    // colliding CID's unlikely. A collision only costs a lost sample.
+    Stamp empty = { false, 0, 0, 0 };
+    mSQ[sqId]->stamps.assign(MAX((numEntries * 2), 2), empty);
+    mSQ[sqId]->unrung.clear();
+    mSQ[sqId]->unrung.reserve(numEntries);
+}
+
+
+void
+CmdLatency::Send(uint16_t sqId, uint16_t cid, uint64_t ns)
+{
+    if ((sqId >= mSQ.size()) || (mSQ[sqId] == NULL))
+        return;
+
+    SQStamps *sq = mSQ[sqId];
+    uint32_t idx = (cid % sq->stamps.size());
+    Stamp &stamp = sq->stamps[idx];
+    stamp.valid = true;
+    stamp.cid = cid;
+    stamp.sendNs = ns;
+    stamp.ringNs = 0;
+    sq->unrung.push_back(idx);
+}
+
+
+void
+CmdLatency::Ring(uint16_t sqId, uint64_t ns)
+{
+    if ((sqId >= mSQ.size()) || (mSQ[sqId] == NULL))
+        return;
+
+    SQStamps *sq = mSQ[sqId];
+    for (size_t i = 0; i < sq->unrung.size(); i++) {
+        Stamp &stamp = sq->stamps[sq->unrung[i]];
+        if (stamp.valid && (stamp.ringNs == 0)) {
+            stamp.ringNs = ns;
+            sq->sendToRing.Record(ns - stamp.sendNs);
+        }
+    }
+    sq->unrung.clear();
+}
+
+
+void
+CmdLatency::Reap(uint16_t sqId, uint16_t cid, uint64_t ns)
+{
+    if ((sqId >= mSQ.size()) || (mSQ[sqId] == NULL))
+        return;
+
+    SQStamps *sq = mSQ[sqId];
+    Stamp &stamp = sq->stamps[cid % sq->stamps.size()];
+    if ((stamp.valid == false) || (stamp.cid != cid))
+        return;
+
+    stamp.valid = false;
+    sq->sendToReap.Record(ns - stamp.sendNs);
+    if (stamp.ringNs)
+        sq->ringToReap.Record(ns - stamp.ringNs);
+}
+
+
+void
+CmdLatency::Log(string desc, uint16_t sqId, const Histogram &sendToRing,
+    const Histogram &ringToReap, const Histogram &sendToReap)
+{
+    char work[80];
+
+    snprintf(work, sizeof(work), "%s: SQ %d send to ring", desc.c_str(), sqId);
+    sendToRing.Log(work, "ns");
+    snprintf(work, sizeof(work), "%s: SQ %d ring to reap", desc.c_str(), sqId);
+    ringToReap.Log(work, "ns");
+    snprintf(work, sizeof(work), "%s: SQ %d send to reap", desc.c_str(), sqId);
+    sendToReap.Log(work, "ns");
+}
+
+
+void
+CmdLatency::LogTest(string desc)
+{
+    for (size_t i = 0; i < mSQ.size(); i++) {
+        SQStamps *sq = mSQ[i];
+        if (sq == NULL)
+            continue;
+
+        Log(desc, i, sq->sendToRing, sq->ringToReap, sq->sendToReap);
+        sq->runSendToRing.Merge(sq->sendToRing);
+        sq->runRingToReap.Merge(sq->ringToReap);
+        sq->runSendToReap.Merge(sq->sendToReap);
+        sq->sendToRing.Clear();
+        sq->ringToReap.Clear();
+        sq->sendToReap.Clear();
+    }
+}
+
+
+void
+CmdLatency::LogRun()
+{
+    for (size_t i = 0; i < mSQ.size(); i++) {
+        SQStamps *sq = mSQ[i];
+        if (sq == NULL)
+            continue;
+
+        Log("All tests", i, sq->runSendToRing, sq->runRingToReap,
+            sq->runSendToReap);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _CMDLATENCY_H_
+#define _CMDLATENCY_H_
+
+#include "tnvme.h"
+#include "histogram.h"
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It timestamps every cmd as it is sent by SQ::Send(), as its
+* SQ doorbell is rung by SQ::Ring(), and as its CE is reaped by CQ::Reap(),
+* correlating all 3 events by the (SQID, CID) of the cmd. The intervals are
+* aggregated into histograms per SQ ID, which outlive the SQ objects
+* themselves:
+*     1) send to ring: time spent by tnvme/dnvme staging the cmd
+*     2) ring to reap: time spent by the ctrlr plus time until tnvme reaped
+*     3) send to reap: the entire life span of the cmd
+*
+* Recording a timestamp is a clock read and a table store, cheap enough to
+* leave enabled always. SQ's must only be created from the main thread, while
+* each SQ and its CQ may thereafter be driven by a different thread.
+*
+* @note This class will not throw exceptions.
+*/
+class CmdLatency
+{
+public:
+    /// @return The number of ns since an arbitrary, but fixed, point in time
+    static uint64_t Now();
+
+    /**
+     * Forget all outstanding timestamps of a newly created SQ, but not its
+     * histograms.
+     * @param sqId Pass the ID of the SQ
+     * @param numEntries Pass the number of elements within the SQ
+     */
+    static void InitSQ(uint16_t sqId, uint32_t numEntries);
+
+    /**
+     * Record a cmd having been sent to an SQ.
+     * @param sqId Pass the ID of the SQ the cmd was sent to
+     * @param cid Pass the CID dnvme assigned the cmd
+     * @param ns Pass the time as returned by Now() just before sending
+     */
+    static void Send(uint16_t sqId, uint16_t cid, uint64_t ns);
+
+    /**
+     * Record all cmds sent to an SQ since its last ring being rung.
+     * @param sqId Pass the ID of the SQ whose doorbell was rung
+     * @param ns Pass the time as returned by Now() just before ringing
+     */
+    static void Ring(uint16_t sqId, uint64_t ns);
+
+    /**
+     * Record a cmd's CE having been reaped.
+     * @param sqId Pass CE.SQID
+     * @param cid Pass CE.CID
+     * @param ns Pass the time as returned by Now() just after reaping
+     */
+    static void Reap(uint16_t sqId, uint16_t cid, uint64_t ns);
+
+    /**
+     * Log the histograms of every SQ which was active since the last call,
+     * then fold them into the totals reported by LogRun().
+     * @param desc Pass a description identifying the period, i.e. a test
+     */
+    static void LogTest(string desc);
+
+    /// Log the histograms of every SQ which was active since the app started
+    static void LogRun();
+
+
+private:
+    CmdLatency();
+    virtual ~CmdLatency();
+
+    struct Stamp {
+        bool     valid;
+        uint16_t cid;
+        uint64_t sendNs;
+        uint64_t ringNs;            // 0 indicates not yet rung
+    };
+
+    struct SQStamps {
+        vector<Stamp> stamps;       // indexed by (CID % stamps.size())
+        vector<uint32_t> unrung;    // stamps indices awaiting a doorbell
+        Histogram sendToRing;
+        Histogram ringToReap;
+        Histogram sendToReap;
+        Histogram runSendToRing;
+        Histogram runRingToReap;
+        Histogram runSendToReap;
+    };
+
+    /// Indexed by SQ ID, NULL if the SQ ID was never created
+    static vector<SQStamps *> mSQ;
+
+    static void Log(string desc, uint16_t sqId, const Histogram &sendToRing,
+        const Histogram &ringToReap, const Histogram &sendToReap);
+};
+
+
+#endif
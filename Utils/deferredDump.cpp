@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "deferredDump.h"
+#include "globals.h"
+
+volatile bool DeferredDump::mActive = false;
+deque<DeferredDump::Snapshot> DeferredDump::mSnapshots;
+vector<DeferredDump::Stream *> DeferredDump::mStreams;
+uint64_t DeferredDump::mBytes = 0;
+uint64_t DeferredDump::mNumDropped = 0;
+pthread_mutex_t DeferredDump::mMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+DeferredDump::DeferredDump()
+{
+}
+
+
+DeferredDump::~DeferredDump()
+{
+}
+
+
+void
+DeferredDump::Begin()
+{
+    pthread_mutex_lock(&mMutex);
+    mSnapshots.clear();
+    mBytes = 0;
+    mNumDropped = 0;
+    mActive = true;
+    pthread_mutex_unlock(&mMutex);
+}
+
+
+void
+DeferredDump::End(bool render)
+{
+    FILE *fp = NULL;
+    string curFile;
+
+    pthread_mutex_lock(&mMutex);
+    mActive = false;
+    deque<Snapshot> snapshots;
+    snapshots.swap(mSnapshots);
+    mBytes = 0;
+    pthread_mutex_unlock(&mMutex);
+
+    if ((render == false) || snapshots.empty())
+        return;
+
+    LOG_NRM("Rendering %ld deferred dumps", snapshots.size());
+    if (mNumDropped) {
+        LOG_WARN("%llu oldest deferred dumps were dropped, exceeded 0x%X bytes",
+            (long long unsigned int)mNumDropped, DEFERRED_DUMP_MAX_BYTES);
+    }
+
+    // Snapshots of the same file are mostly consecutive, reuse the stream
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        Snapshot &snap = snapshots[i];
+        if ((fp == NULL) || (snap.filename != curFile)) {
+            if (fp)
+                fclose(fp);
+            curFile = snap.filename;
+            if ((fp = fopen(curFile.c_str(), "a")) == NULL) {
+                LOG_ERR("Failed to open file: %s", curFile.c_str());
+                continue;
+            }
+        }
+        snap.fn(fp, curFile, (snap.raw.empty() ? NULL : &snap.raw[0]),
+            snap.raw.size(), snap.arg, snap.text);
+    }
+    if (fp)
+        fclose(fp);
+}
+
+
+void
+DeferredDump::Capture(DumpFilename filename, DumpRenderFn fn,
+    const uint8_t *raw, size_t len, uint32_t arg, string text)
+{
+    if (mActive == false) {
+        FILE *fp;
+        if ((fp = fopen(filename.c_str(), "a")) == NULL)
+            throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+        fn(fp, filename, raw, len, arg, text);
+        fclose(fp);
+        return;
+    }
+
+    Snapshot snap;
+    snap.filename = filename;
+    snap.fn = fn;
+    if (len)
+        snap.raw.assign(raw, (raw + len));
+    snap.arg = arg;
+    snap.text = text;
+    Retain(snap);
+}
+
+
+FILE *
+DeferredDump::Open(DumpFilename filename)
+{
+    FILE *fp;
+
+    if (mActive == false) {
+        if ((fp = fopen(filename.c_str(), "a")) == NULL)
+            throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+        return fp;
+    }
+
+    // open_memstream() updates buf and len, thus they must not move
+    Stream *stream = new Stream();
+    stream->buf = NULL;
+    stream->len = 0;
+    stream->filename = filename;
+    if ((stream->fp = open_memstream(&stream->buf, &stream->len)) == NULL) {
+        delete stream;
+        throw FrmwkEx(HERE, "Failed to open memory stream: %s",
+            filename.c_str());
+    }
+
+    pthread_mutex_lock(&mMutex);
+    mStreams.push_back(stream);
+    pthread_mutex_unlock(&mMutex);
+    return stream->fp;
+}
+
+
+void
+DeferredDump::Close(FILE *fp)
+{
+    Stream *stream = NULL;
+
+    pthread_mutex_lock(&mMutex);
+    for (size_t i = 0; i < mStreams.size(); i++) {
+        if (mStreams[i]->fp == fp) {
+            stream = mStreams[i];
+            mStreams.erase(mStreams.begin() + i);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    fclose(fp);
+    if (stream == NULL)
+        return;     // a real file opened when not deferring
+
+    // The stream's buffer is only valid after fclose()
+    Snapshot snap;
+    snap.filename = stream->filename;
+    snap.fn = RenderRaw;
+    snap.raw.assign((uint8_t *)stream->buf,
+        ((uint8_t *)stream->buf + stream->len));
+    snap.arg = 0;
+    free(stream->buf);
+    delete stream;
+
+    // Deferral may have ended while the stream was open
+    if (mActive) {
+        Retain(snap);
+    } else if ((fp = fopen(snap.filename.c_str(), "a")) != NULL) {
+        RenderRaw(fp, snap.filename, (snap.raw.empty() ? NULL : &snap.raw[0]),
+            snap.raw.size(), 0, "");
+        fclose(fp);
+    }
+}
+
+
+void
+DeferredDump::RenderRaw(FILE *fp, DumpFilename, const uint8_t *raw,
+    size_t len, uint32_t, const string &)
+{
+    if (len)
+        fwrite(raw, 1, len, fp);
+}
+
+
+void
+DeferredDump::Retain(Snapshot &snap)
+{
+    pthread_mutex_lock(&mMutex);
+    mBytes += snap.raw.size();
+    mSnapshots.push_back(Snapshot());
+    mSnapshots.back().filename.swap(snap.filename);
+    mSnapshots.back().fn = snap.fn;
+    mSnapshots.back().raw.swap(snap.raw);
+    mSnapshots.back().arg = snap.arg;
+    mSnapshots.back().text.swap(snap.text);
+
+    // Act as a ring, the most recent dumps are the most valuable
+    while ((mBytes > DEFERRED_DUMP_MAX_BYTES) && (mSnapshots.size() > 1)) {
+        mBytes -= mSnapshots.front().raw.size();
+        mSnapshots.pop_front();
+        mNumDropped++;
+    }
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _DEFERREDDUMP_H_
+#define _DEFERREDDUMP_H_
+
+#include <deque>
+#include <pthread.h>
+#include "tnvme.h"
+#include "fileSystem.h"
+
+/// Bytes of raw snapshots retained per test, the oldest are dropped beyond
+#define DEFERRED_DUMP_MAX_BYTES     (64 * 1024 * 1024)
+
+/**
+ * Renders a raw snapshot as text into a dump file.
+ * @param fp Pass the dump file, opened for appending
+ * @param filename Pass the name of the dump file
+ * @param raw Pass the raw bytes which were snapshot
+ * @param len Pass the number of raw bytes
+ * @param arg Pass the renderer specific arg which was snapshot
+ * @param text Pass the renderer specific text which was snapshot
+ */
+typedef void (*DumpRenderFn)(FILE *fp, DumpFilename filename,
+    const uint8_t *raw, size_t len, uint32_t arg, const string &text);
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. Dumps are only ever looked at when a test fails, however
+* formatting raw queues, cmds and buffers into hex and decoded text costs far
+* more than the tests producing them. Between Begin() and End() every dump is
+* merely a snapshot of its raw bytes held in memory, rendered into the named
+* file by End() only if the test failed or --postfail was requested, and
+* otherwise discarded. Outside of Begin()/End() dumps are rendered
+* immediately as they always were.
+*
+* @note This class may throw exceptions.
+*/
+class DeferredDump
+{
+public:
+    /// Start snapshotting dumps rather than rendering them
+    static void Begin();
+
+    /**
+     * Stop snapshotting dumps.
+     * @param render Pass true to render every snapshot into its file,
+     *      otherwise they are discarded
+     */
+    static void End(bool render);
+
+    static bool IsActive() { return mActive; }
+
+    /**
+     * Dump raw data via a renderer, either now or deferred to End().
+     * @note This method may throw when rendering immediately
+     * @param filename Pass the name of the file to append
+     * @param fn Pass the renderer of the raw data
+     * @param raw Pass the raw data to render, it is copied when deferring
+     * @param len Pass the number of bytes of raw data
+     * @param arg Pass any arg the renderer requires
+     * @param text Pass any text the renderer requires
+     */
+    static void Capture(DumpFilename filename, DumpRenderFn fn,
+        const uint8_t *raw, size_t len, uint32_t arg = 0, string text = "");
+
+    /**
+     * Open a dump file to be written with stdio, appending to any dumps
+     * previously captured for the same file. When deferring the writes land
+     * in memory, thus the text is formatted now but only written by End().
+     * @note This method may throw
+     * @param filename Pass the name of the file to append
+     * @return The stream to write, which must be passed to Close()
+     */
+    static FILE *Open(DumpFilename filename);
+
+    /**
+     * Close a stream returned by Open(), capturing what was written to it.
+     * @param fp Pass the stream returned by Open()
+     */
+    static void Close(FILE *fp);
+
+    /// A renderer which writes the raw bytes unmodified
+    static void RenderRaw(FILE *fp, DumpFilename filename, const uint8_t *raw,
+        size_t len, uint32_t arg, const string &text);
+
+
+private:
+    DeferredDump();
+    virtual ~DeferredDump();
+
+    struct Snapshot {
+        string filename;
+        DumpRenderFn fn;
+        vector<uint8_t> raw;
+        uint32_t arg;
+        string text;
+    };
+
+    struct Stream {
+        FILE *fp;
+        char *buf;
+        size_t len;
+        string filename;
+    };
+
+    static volatile bool mActive;
+    static deque<Snapshot> mSnapshots;
+    static vector<Stream *> mStreams;
+    static uint64_t mBytes;
+    static uint64_t mNumDropped;
+    static pthread_mutex_t mMutex;
+
+    /// Retain a snapshot, dropping the oldest to stay within limits
+    static void Retain(Snapshot &snap);
+};
+
+
+#endif
@@ -18,18 +18,30 @@
 #include <sys/stat.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/time.h>
 #include <boost/filesystem.hpp>
 #include "fileSystem.h"
+#include "globals.h"
 #include "../Exception/frmwkEx.h"
 
 #define BASE_NAME_DIR_INFO      "/Informative/"
 #define BASE_NAME_PENDING       "/GrpPending/"
+#define STALE_SUFFIX            ".stale"
 
 using namespace std;
 
 bool FileSystem::mUseDirInfo = true;
 string FileSystem::mDumpDirInfo;
 string FileSystem::mDumpDirPending;
+deque<string> FileSystem::mStale;
+pthread_mutex_t FileSystem::mStaleMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t FileSystem::mStaleCond = PTHREAD_COND_INITIALIZER;
+pthread_t FileSystem::mReaper;
+bool FileSystem::mReaperRunning = false;
+bool FileSystem::mReaperStop = false;
 
 
 FileSystem::FileSystem()
@@ -45,26 +57,35 @@ FileSystem::~FileSystem()
 bool
 FileSystem::SetRootDumpDir(string dir)
 {
-    char work[256];
-
     mDumpDirPending = (dir + BASE_NAME_PENDING);
     mDumpDirInfo = (dir + BASE_NAME_DIR_INFO);
 
     try {
         if (boost::filesystem::exists(dir.c_str())) {
+            // Stale dirs left behind by a previous run which didn't Drain()
+            DIR *root = opendir(dir.c_str());
+            struct dirent *entry;
+            while (root && ((entry = readdir(root)) != NULL)) {
+                size_t len = strlen(entry->d_name);
+                if ((len > strlen(STALE_SUFFIX)) && (strcmp(entry->d_name +
+                    len - strlen(STALE_SUFFIX), STALE_SUFFIX) == 0)) {
+                    Reap(dir + "/" + entry->d_name);
+                }
+            }
+            if (root)
+                closedir(root);
+
             SetBaseDumpDir(false);
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirPending.c_str());
-            system(work);
-            if (CleanDumpDir() == false)
+            if ((MakeDir(mDumpDirPending) == false) ||
+                (CleanDumpDir() == false)) {
                 return false;
+            }
 
             SetBaseDumpDir(true);    // this is the default
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirInfo.c_str());
-            system(work);
-            if (CleanDumpDir() == false)
+            if ((MakeDir(mDumpDirInfo) == false) ||
+                (CleanDumpDir() == false)) {
                 return false;
+            }
 
             return true;
         } else {
@@ -81,7 +102,6 @@ FileSystem::SetRootDumpDir(string dir)
 bool
 FileSystem::CleanDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
 
     if (dumpDir.empty()) {
@@ -89,10 +109,54 @@ FileSystem::CleanDumpDir()
         return false;
     }
 
+    int fd = open(dumpDir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd == -1) {
+        if (errno == ENOENT)
+            return true;
+        LOG_ERR("Unable to open %s: %s", dumpDir.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (gCmdLine.dumpAsync) {
+        // Nothing to do for an already empty dir, otherwise move it aside
+        DIR *dir = fdopendir(dup(fd));
+        struct dirent *entry;
+        bool empty = true;
+        while (dir && ((entry = readdir(dir)) != NULL)) {
+            if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+                empty = false;
+                break;
+            }
+        }
+        if (dir)
+            closedir(dir);
+        if (empty) {
+            close(fd);
+            return true;
+        }
+
+        static uint32_t seq = 0;
+        char stamp[64];
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        snprintf(stamp, sizeof(stamp), ".%ld.%06ld.%u" STALE_SUFFIX,
+            (long)tv.tv_sec, (long)tv.tv_usec, seq++);
+
+        string live = dumpDir.substr(0, dumpDir.find_last_not_of('/') + 1);
+        string stale = live + stamp;
+        if (rename(live.c_str(), stale.c_str()) == 0) {
+            close(fd);
+            if (MakeDir(dumpDir) == false)
+                return false;
+            Reap(stale);
+            return true;
+        }
+        LOG_WARN("Unable to rename %s, cleaning in place: %s",
+            live.c_str(), strerror(errno));
+    }
+
     // Remove everything in the dir, not the dir itself
-    snprintf(work, sizeof(work), "rm -rf %s*", dumpDir.c_str());
-    system(work);
-    if (boost::filesystem::exists(work)) {
+    if (RemoveContents(fd) == false) {
         LOG_ERR("Unable to remove files within: %s", dumpDir.c_str());
         return false;
     }
@@ -103,31 +167,58 @@ FileSystem::CleanDumpDir()
 bool
 FileSystem::RotateDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
 
     if (dumpDir.empty())
         return true;
 
+    int fd = open(dumpDir.c_str(), O_RDONLY | O_DIRECTORY);
+    DIR *dir = (fd == -1) ? NULL : fdopendir(dup(fd));
+    if (dir == NULL) {
+        LOG_ERR("Unable to open %s: %s", dumpDir.c_str(), strerror(errno));
+        if (fd != -1)
+            close(fd);
+        return false;
+    }
+
+    // Get a vector of filenames of all files within dir
+    vector<string> allFiles;
+    vector<bool> allDirs;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..")) {
+            allFiles.push_back(entry->d_name);
+            allDirs.push_back(entry->d_type == DT_DIR);
+        }
+    }
+    closedir(dir);
+
     // Remove everything in the dir of the form "*.prev"
-    snprintf(work, sizeof(work), "rm %s*.prev", dumpDir.c_str());
-    system(work);
+    const string prev = ".prev";
+    for (size_t i = 0; i < allFiles.size(); i++) {
+        if ((allFiles[i].length() > prev.length()) &&
+            (allFiles[i].compare(allFiles[i].length() - prev.length(),
+            prev.length(), prev) == 0)) {
 
-    // Get a vector of filenames of all other files within dir
-    boost::filesystem::path targDir(dumpDir);
-    vector<boost::filesystem::path> allFiles;
-    copy(boost::filesystem::directory_iterator(targDir),
-        boost::filesystem::directory_iterator(), back_inserter(allFiles));
+            RemoveAt(fd, allFiles[i].c_str(), allDirs[i]);
+            allFiles[i].clear();
+        }
+    }
 
-    // Rename all files to "*.prev"
+    // Rename all other files to "*.prev"
+    bool status = true;
     for (size_t i = 0; i < allFiles.size(); i++) {
-        string newName = (allFiles[i].filename() + ".prev");
-        snprintf(work, sizeof(work), "mv %s%s %s%s.prev",
-            dumpDir.c_str(), allFiles[i].filename().c_str(),
-            dumpDir.c_str(), allFiles[i].filename().c_str());
-        system(work);
+        if (allFiles[i].empty())
+            continue;
+        string newName = (allFiles[i] + prev);
+        if (renameat(fd, allFiles[i].c_str(), fd, newName.c_str()) == -1) {
+            LOG_ERR("Unable to rename %s%s: %s", dumpDir.c_str(),
+                allFiles[i].c_str(), strerror(errno));
+            status = false;
+        }
     }
-    return true;
+    close(fd);
+    return status;
 }
 
 
@@ -148,3 +239,137 @@ FileSystem::PrepDumpFile(string grpName, string className, string objName,
         file += "." + qualifier;
     return file;
 }
+
+
+void
+FileSystem::Drain()
+{
+    pthread_mutex_lock(&mStaleMutex);
+    if (mReaperRunning == false) {
+        pthread_mutex_unlock(&mStaleMutex);
+        return;
+    }
+    mReaperStop = true;
+    pthread_cond_signal(&mStaleCond);
+    pthread_mutex_unlock(&mStaleMutex);
+
+    pthread_join(mReaper, NULL);
+    mReaperRunning = false;
+    mReaperStop = false;
+}
+
+
+bool
+FileSystem::MakeDir(string dir)
+{
+    // Create each missing parent, then force the mode of the leaf
+    for (size_t pos = dir.find('/', 1); pos != string::npos;
+        pos = dir.find('/', pos + 1)) {
+
+        string parent = dir.substr(0, pos);
+        if ((mkdir(parent.c_str(), 0777) == -1) && (errno != EEXIST)) {
+            LOG_ERR("Unable to create %s: %s", parent.c_str(),
+                strerror(errno));
+            return false;
+        }
+    }
+    if ((mkdir(dir.c_str(), 0777) == -1) && (errno != EEXIST)) {
+        LOG_ERR("Unable to create %s: %s", dir.c_str(), strerror(errno));
+        return false;
+    }
+    chmod(dir.c_str(), 0777);
+    return true;
+}
+
+
+bool
+FileSystem::RemoveContents(int dirFd)
+{
+    DIR *dir = fdopendir(dirFd);
+    if (dir == NULL) {
+        close(dirFd);
+        return false;
+    }
+
+    bool status = true;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if ((strcmp(entry->d_name, ".") == 0) ||
+            (strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+        if (RemoveAt(dirfd(dir), entry->d_name, entry->d_type == DT_DIR) ==
+            false) {
+            status = false;
+        }
+    }
+    closedir(dir);
+    return status;
+}
+
+
+bool
+FileSystem::RemoveAt(int dirFd, const char *name, bool isDir)
+{
+    // d_type may be DT_UNKNOWN on some file systems, unlinkat() tells us
+    if ((isDir == false) && (unlinkat(dirFd, name, 0) == 0))
+        return true;
+    if ((isDir == false) && (errno != EISDIR) && (errno != EPERM))
+        return false;
+
+    int fd = openat(dirFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+    if (fd == -1)
+        return false;
+    if (RemoveContents(fd) == false)
+        return false;
+    return (unlinkat(dirFd, name, AT_REMOVEDIR) == 0);
+}
+
+
+void
+FileSystem::Reap(string dir)
+{
+    pthread_mutex_lock(&mStaleMutex);
+    mStale.push_back(dir);
+    if (mReaperRunning == false) {
+        if (pthread_create(&mReaper, NULL, Reaper, &mStale) == 0) {
+            mReaperRunning = true;
+        } else {
+            // Without a thread the caller pays for the deletion
+            pthread_mutex_unlock(&mStaleMutex);
+            Reaper(NULL);
+            return;
+        }
+    }
+    pthread_cond_signal(&mStaleCond);
+    pthread_mutex_unlock(&mStaleMutex);
+}
+
+
+void *
+FileSystem::Reaper(void *arg)
+{
+    bool thread = (arg != NULL);    // NULL when called synchronously
+
+    pthread_mutex_lock(&mStaleMutex);
+    while (true) {
+        while (mStale.empty()) {
+            if ((thread == false) || mReaperStop) {
+                pthread_mutex_unlock(&mStaleMutex);
+                return NULL;
+            }
+            pthread_cond_wait(&mStaleCond, &mStaleMutex);
+        }
+        string dir = mStale.front();
+        mStale.pop_front();
+        pthread_mutex_unlock(&mStaleMutex);
+
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+        if ((fd == -1) || (RemoveContents(fd) == false) ||
+            (rmdir(dir.c_str()) == -1)) {
+            LOG_WARN("Unable to remove stale dump dir: %s", dir.c_str());
+        }
+
+        pthread_mutex_lock(&mStaleMutex);
+    }
+}
@@ -18,6 +18,8 @@
 #define _FILESYSTEM_H_
 
 #include <limits.h>
+#include <pthread.h>
+#include <deque>
 #include "tnvme.h"
 
 
@@ -72,7 +74,10 @@ public:
      * Cleans all files from the base dump directory. Each new group which
      * executes should start dumping to an empty directory. This approach keeps
      * only the last group's dumps and attempts to prevent the file system from
-     * breaching a maximum limit.
+     * breaching a maximum limit. When gCmdLine.dumpAsync is set a populated
+     * directory is instead renamed aside to a timestamped name, a fresh one
+     * is created in its place and the stale one is deleted by a background
+     * thread; thus the caller never waits upon a large dump tree.
      * @note This method will not throw
      * @return true if successful, otherwise false;
      */
@@ -99,12 +104,58 @@ public:
     static DumpFilename PrepDumpFile(string grpName, string className,
         string objName, string qualifier = "");
 
+    /**
+     * Blocks until the background thread has deleted every stale dump
+     * directory handed to it by CleanDumpDir(), then stops that thread.
+     * @note This method will not throw
+     */
+    static void Drain();
+
 
 private:
     /// true uses mDumpDirGrpInfo; false uses mDumpDirPending
     static bool mUseDirInfo;
     static string mDumpDirInfo;
     static string mDumpDirPending;
+
+    /// Stale dump directories awaiting deletion by mReaper
+    static deque<string> mStale;
+    static pthread_mutex_t mStaleMutex;
+    static pthread_cond_t mStaleCond;
+    static pthread_t mReaper;
+    static bool mReaperRunning;
+    static bool mReaperStop;
+
+    /**
+     * Equivalent to "mkdir -p -m 777 <dir>".
+     * @param dir Pass the name of the directory to create
+     * @return true if the directory exists upon return, otherwise false
+     */
+    static bool MakeDir(string dir);
+
+    /**
+     * Recursively deletes everything within a directory, but not the
+     * directory itself.
+     * @param dirFd Pass an open descriptor of the directory, it is closed
+     * @return true if successful, otherwise false
+     */
+    static bool RemoveContents(int dirFd);
+
+    /**
+     * Deletes a file or a directory tree relative to a directory.
+     * @param dirFd Pass an open descriptor of the parent directory
+     * @param name Pass the name of the entry within the parent directory
+     * @param isDir Pass true if the entry is known to be a directory
+     * @return true if successful, otherwise false
+     */
+    static bool RemoveAt(int dirFd, const char *name, bool isDir);
+
+    /**
+     * Queues a stale directory for deletion, starting mReaper if needed.
+     * @param dir Pass the name of the directory to delete
+     */
+    static void Reap(string dir);
+    static void *Reaper(void *arg);
 };
 
 
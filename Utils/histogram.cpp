@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "histogram.h"
+
+
+Histogram::Histogram()
+{
+    Clear();
+}
+
+
+Histogram::~Histogram()
+{
+}
+
+
+void
+Histogram::Clear()
+{
+    mCount = 0;
+    mSum = 0;
+    mMin = (uint64_t)-1;
+    mMax = 0;
+    memset(mBuckets, 0, sizeof(mBuckets));
+}
+
+
+uint32_t
+Histogram::ValueToBucket(uint64_t value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+        return (uint32_t)value;
+
+    // The 5 most significant bits select the bucket; the MSB selects the
+    // power of 2 range and the following 4 bits select the sub-bucket.
+    uint32_t msb = (63 - __builtin_clzll(value));
+    uint32_t shift = (msb - 4);
+    uint32_t sub = (uint32_t)((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+    return (((msb - 3) * HISTOGRAM_SUB_BUCKETS) + sub);
+}
+
+
+uint64_t
+Histogram::BucketToValue(uint32_t bucket)
+{
+    if (bucket < HISTOGRAM_SUB_BUCKETS)
+        return bucket;
+
+    uint32_t range = (bucket / HISTOGRAM_SUB_BUCKETS);
+    uint64_t sub = (bucket % HISTOGRAM_SUB_BUCKETS);
+    uint32_t shift = (range - 1);
+    return ((((HISTOGRAM_SUB_BUCKETS + sub) + 1) << shift) - 1);
+}
+
+
+void
+Histogram::Record(uint64_t value)
+{
+    mBuckets[ValueToBucket(value)]++;
+    mCount++;
+    mSum += value;
+    if (value < mMin)
+        mMin = value;
+    if (value > mMax)
+        mMax = value;
+}
+
+
+void
+Histogram::Merge(const Histogram &other)
+{
+    if (other.mCount == 0)
+        return;
+
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        mBuckets[i] += other.mBuckets[i];
+    mCount += other.mCount;
+    mSum += other.mSum;
+    if (other.mMin < mMin)
+        mMin = other.mMin;
+    if (other.mMax > mMax)
+        mMax = other.mMax;
+}
+
+
+uint64_t
+Histogram::GetPercentile(double percentile) const
+{
+    if (mCount == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)((percentile / 100.0) * mCount);
+    if (target >= mCount)
+        return mMax;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += mBuckets[i];
+        if (seen > target)
+            return MIN(BucketToValue(i), mMax);
+    }
+    return mMax;
+}
+
+
+void
+Histogram::Log(string desc, string units) const
+{
+    if (mCount == 0)
+        return;
+
+    LOG_NRM("%s (%s): n=%llu, min=%llu, mean=%llu, p50=%llu, p99=%llu, "
+        "p99.9=%llu, max=%llu", desc.c_str(), units.c_str(),
+        (long long unsigned int)GetCount(),
+        (long long unsigned int)GetMin(),
+        (long long unsigned int)GetMean(),
+        (long long unsigned int)GetPercentile(50.0),
+        (long long unsigned int)GetPercentile(99.0),
+        (long long unsigned int)GetPercentile(99.9),
+        (long long unsigned int)GetMax());
+}
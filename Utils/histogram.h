@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include "tnvme.h"
+
+/// Number of linear sub-buckets within every power of 2 range of values
+#define HISTOGRAM_SUB_BUCKETS               16
+/// 4 bits of sub-bucket resolution leave 60 power of 2 ranges to a uint64_t
+#define HISTOGRAM_BUCKETS                   (61 * HISTOGRAM_SUB_BUCKETS)
+
+
+/**
+* This class implements a fixed memory, high dynamic range histogram intended
+* to record latencies. Values are sorted into power of 2 ranges, and each range
+* is further split into HISTOGRAM_SUB_BUCKETS linear buckets, thus any
+* recorded value is reported within ~6% of its true value regardless of its
+* magnitude. Recording is a handful of instructions and never allocates, thus
+* it is cheap enough to be left enabled on hot paths.
+*
+* @note This class does not throw exceptions.
+*/
+class Histogram
+{
+public:
+    Histogram();
+    virtual ~Histogram();
+
+    /// Forget all previously recorded values
+    void Clear();
+
+    /**
+     * Record a single value into the histogram.
+     * @param value Pass the value to record, units are up to the caller
+     */
+    void Record(uint64_t value);
+
+    /**
+     * Fold all the values recorded by another histogram into this one.
+     * @param other Pass the histogram to merge
+     */
+    void Merge(const Histogram &other);
+
+    uint64_t GetCount() const { return mCount; }
+    uint64_t GetMin() const { return (mCount ? mMin : 0); }
+    uint64_t GetMax() const { return mMax; }
+    uint64_t GetMean() const { return (mCount ? (mSum / mCount) : 0); }
+
+    /**
+     * Report the value below which the specified percentage of all recorded
+     * values reside.
+     * @param percentile Pass a value within [0.0 - 100.0]
+     * @return The upper bound of the bucket containing the percentile; 0 when
+     *      nothing has been recorded.
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+    /**
+     * Send a one line summary of this histogram to the logging endpoint.
+     * Nothing will be logged if nothing has been recorded.
+     * @param desc Pass a description identifying what was recorded
+     * @param units Pass the units of the recorded values
+     */
+    void Log(string desc, string units) const;
+
+
+private:
+    uint64_t mCount;
+    uint64_t mSum;
+    uint64_t mMin;
+    uint64_t mMax;
+    uint64_t mBuckets[HISTOGRAM_BUCKETS];
+
+    /// Convert a value into the index of the bucket which records it
+    static uint32_t ValueToBucket(uint64_t value);
+    /// Convert a bucket index into the largest value it records
+    static uint64_t BucketToValue(uint32_t bucket);
+};
+
+
+#endif
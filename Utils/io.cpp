@@ -19,6 +19,9 @@
 #include "kernelAPI.h"
 #include "globals.h"
 #include "io.h"
+#include "ceDispatcher.h"
+#include "aerService.h"
+#include "traceLog.h"
 
 
 IO::IO()
@@ -47,6 +50,28 @@ CEStat
 IO::SendAndReapCmd(string grpName, string testName, uint16_t ms,
     SharedSQPtr sq, SharedCQPtr cq, SharedCmdPtr cmd, string qualify,
     bool verbose, std::vector<CEStat> &status)
+{
+    return SendAndReap(grpName, testName, ms, sq, cq, cmd, NULL, qualify,
+        verbose, status);
+}
+
+
+CEStat
+IO::SendAndReapCmd(string grpName, string testName, uint16_t ms,
+    SharedSQPtr sq, SharedCQPtr cq, CmdTemplate &tmpl, string qualify,
+    bool verbose, CEStat status)
+{
+    std::vector<CEStat> localStatus;
+    localStatus.push_back(status);
+    return SendAndReap(grpName, testName, ms, sq, cq, tmpl.GetCmd(), &tmpl,
+        qualify, verbose, localStatus);
+}
+
+
+CEStat
+IO::SendAndReap(string grpName, string testName, uint16_t ms,
+    SharedSQPtr sq, SharedCQPtr cq, SharedCmdPtr cmd, CmdTemplate *tmpl,
+    string qualify, bool verbose, std::vector<CEStat> &status)
 {
     uint32_t numCE;
     uint32_t isrCount;
@@ -54,6 +79,18 @@ IO::SendAndReapCmd(string grpName, string testName, uint16_t ms,
     uint16_t uniqueId;
 
 
+    // An AER service owns reaping the ACQ while running, share it with it
+    AERService *aer = AERService::GetActive(cq);
+    if (aer != NULL) {
+        if (sq->GetCqId() != cq->GetQId()) {
+            throw FrmwkEx(HERE, "SQ %d is not associated with CQ %d",
+                sq->GetQId(), cq->GetQId());
+        }
+        if (tmpl != NULL)
+            throw FrmwkEx(HERE, "Templates can't be sent to an AER's CQ");
+        return aer->SendAndReapCmd(ms, cmd, qualify, verbose, status);
+    }
+
     if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
         cq->Dump(
             FileSystem::PrepDumpFile(grpName, testName, "cq",
@@ -62,8 +99,11 @@ IO::SendAndReapCmd(string grpName, string testName, uint16_t ms,
             cq->GetQId(), numCE);
     }
 
-    LOG_NRM("Send the cmd to hdw via SQ %d", sq->GetQId());
-    sq->Send(cmd, uniqueId);
+    LOG_TRACE(TRC_IO_SEND, sq->GetQId());
+    if (tmpl != NULL)
+        uniqueId = sq->SendTemplate(*tmpl);
+    else
+        sq->Send(cmd, uniqueId);
     if (verbose) {
         work = str(boost::format(
             "Just B4 ringing SQ %d doorbell, dump entire SQ") % sq->GetQId());
@@ -72,7 +112,7 @@ IO::SendAndReapCmd(string grpName, string testName, uint16_t ms,
     }
     sq->Ring();
 
-    LOG_NRM("Wait for the CE to arrive in CQ %d", cq->GetQId());
+    LOG_TRACE(TRC_IO_WAIT, cq->GetQId());
     if (cq->ReapInquiryWaitSpecify(ms, 1, numCE, isrCount) == false) {
         work = str(boost::format(
             "Unable to see any CE's in CQ %d, dump entire CQ") % cq->GetQId());
@@ -123,24 +163,19 @@ IO::ReapCE(SharedCQPtr cq, uint32_t numCE, uint32_t &isrCount,
     std::vector<CEStat> &status)
 {
     uint32_t ceRemain;
-    uint32_t numReaped;
     string work;
 
-    LOG_NRM("The CQ's metrics before reaping holds head_ptr");
-    struct nvme_gen_cq cqMetrics = cq->GetQMetrics();
-    KernelAPI::LogCQMetrics(cqMetrics);
-
-    LOG_NRM("Reaping CE from CQ %d, requires memory to hold CE", cq->GetQId());
-    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
-    if ((numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true)) != 1) {
+    // Reaping to the CQ's scratch buffer avoids allocating a MemBuffer per CE
+    CESpan ces = cq->ReapToScratch(ceRemain, isrCount, numCE);
+    if (ces.size() != 1) {
         work = str(boost::format("Verified CE's exist, desired %d, reaped %d")
-            % numCE % numReaped);
+            % numCE % ces.size());
         cq->Dump(
             FileSystem::PrepDumpFile(grpName, testName, "cq.error", qualify),
             work);
         throw FrmwkEx(HERE, work);
     }
-    union CE ce = cq->PeekCE(cqMetrics.head_ptr);
+    union CE ce = ces[0];
 
     if (status.empty()) {
         throw FrmwkEx(HERE,
@@ -158,3 +193,126 @@ IO::ReapCE(SharedCQPtr cq, uint32_t numCE, uint32_t &isrCount,
         status.size());
 }
 
+
+/**
+ * Holds a cmd outstanding within IO::Pipeline() until its CE is dispatched,
+ * whereupon the slot queues itself for processing.
+ */
+class PipelineSlot : public CEListener
+{
+public:
+    SharedCmdPtr cmd;
+    CmdTemplate *tmpl;
+    union CE ce;
+    uint32_t idx;
+    vector<uint32_t> *completed;
+
+    virtual void Completed(const union CE &ce)
+        { this->ce = ce; completed->push_back(idx); }
+};
+
+
+uint64_t
+IO::Pipeline(string grpName, string testName, uint16_t ms,
+    SharedSQPtr sq, SharedCQPtr cq, CmdGenerator &gen, uint32_t qDepth,
+    string qualify, bool verbose, CEStat status)
+{
+    uint32_t numCE;
+    uint32_t isrCount;
+    uint16_t uniqueId;
+    uint64_t numDone = 0;
+    bool genDone = false;
+    SharedCmdPtr cmd;
+    CmdTemplate *tmpl;
+    string work;
+
+
+    if ((numCE = cq->ReapInquiry(isrCount, true)) != 0) {
+        cq->Dump(
+            FileSystem::PrepDumpFile(grpName, testName, "cq",
+            "notEmpty"), "Test assumption have not been met");
+        throw FrmwkEx(HERE, "Require 0 CE's within CQ %d, not upheld, found %d",
+            cq->GetQId(), numCE);
+    }
+
+    // Per NVME spec: 1 empty element implies a full Q, can't truly fill all
+    qDepth = MIN(qDepth, (sq->GetNumEntries() - 1));
+    qDepth = MIN(qDepth, (cq->GetNumEntries() - 1));
+    if (qDepth == 0)
+        throw FrmwkEx(HERE, "Pipeline requires a queue depth >= 1");
+    LOG_TRACE(TRC_IO_PIPELINE, sq->GetQId(), cq->GetQId(), qDepth);
+
+    // Every outstanding cmd occupies a slot; nothing allocates hereafter
+    CEDispatcher dispatcher(grpName, testName, cq, qDepth);
+    vector<PipelineSlot> slots(qDepth);
+    vector<uint32_t> freeSlots;
+    vector<uint32_t> completed;
+    completed.reserve(qDepth);
+    for (uint32_t i = 0; i < qDepth; i++) {
+        slots[i].idx = i;
+        slots[i].completed = &completed;
+        freeSlots.push_back(qDepth - i - 1);
+    }
+
+    while (true) {
+        // Top up the SQ and ring once for all that were added
+        uint32_t numSent = 0;
+        while ((genDone == false) && (freeSlots.empty() == false)) {
+            if ((genDone = !gen.NextTemplate(cmd, tmpl)))
+                break;
+            PipelineSlot &slot = slots[freeSlots.back()];
+            freeSlots.pop_back();
+            if (tmpl != NULL)
+                uniqueId = sq->SendTemplate(*tmpl);
+            else
+                sq->Send(cmd, uniqueId);
+            slot.cmd = cmd;
+            slot.tmpl = tmpl;
+            dispatcher.Register(sq->GetQId(), uniqueId, &slot);
+            numSent++;
+        }
+        if (numSent)
+            sq->Ring();
+        if (dispatcher.GetNumPending() == 0)
+            break;
+
+        if (cq->ReapInquiryWaitAny(ms, numCE, isrCount) == false) {
+            work = str(boost::format(
+                "Unable to see any CE's in CQ %d, %d cmds outstanding, "
+                "dump entire CQ") % cq->GetQId() % dispatcher.GetNumPending());
+            cq->Dump(FileSystem::PrepDumpFile(grpName, testName, "cq.pipeline",
+                qualify), work);
+            throw FrmwkEx(HERE, work);
+        }
+
+        completed.clear();
+        dispatcher.Dispatch(numCE);
+        for (size_t i = 0; i < completed.size(); i++) {
+            PipelineSlot &slot = slots[completed[i]];
+            cmd = slot.cmd;
+
+            if (ProcessCE::ValidatePeek(slot.ce, status) == false) {
+                work = str(boost::format(
+                    "Cmd CID 0x%04X completed w/ unexpected status, "
+                    "dump entire CQ") % (uint16_t)slot.ce.n.CID);
+                cq->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    "cq." + cmd->GetName(), qualify), work);
+                cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    cmd->GetName(), qualify), "A cmd's contents dumped");
+                throw FrmwkEx(HERE, work);
+            }
+            if (verbose) {
+                cmd->Dump(FileSystem::PrepDumpFile(grpName, testName,
+                    cmd->GetName(), qualify), "A cmd's contents dumped");
+            }
+
+            gen.Completed(cmd, slot.tmpl, slot.ce);
+            slot.cmd.reset();
+            freeSlots.push_back(slot.idx);
+            numDone++;
+        }
+    }
+
+    LOG_TRACE(TRC_IO_PIPELINE_DONE, numDone);
+    return numDone;
+}
@@ -23,6 +23,47 @@
 #include "../Queues/cq.h"
 
 
+/**
+* Supplies the cmds which IO::Pipeline() keeps in flight. Every cmd handed out
+* must remain unique until it completes, i.e. the same cmd object, nor its
+* data buffers, may be outstanding twice at the same time.
+*/
+class CmdGenerator
+{
+public:
+    virtual ~CmdGenerator() {}
+
+    /**
+     * Supply the next cmd to send.
+     * @param cmd Returns the next cmd to send
+     * @return false when all cmds have been supplied, otherwise true
+     */
+    virtual bool Next(SharedCmdPtr &cmd) = 0;
+
+    /**
+     * Supply the next cmd to send, optionally as a template which allows it
+     * to be sent via SQ::SendTemplate(). The default defers to Next().
+     * @param cmd Returns the next cmd to send, tmpl->GetCmd() if a template
+     *      is returned.
+     * @param tmpl Returns the template of the cmd, otherwise NULL
+     * @return false when all cmds have been supplied, otherwise true
+     */
+    virtual bool NextTemplate(SharedCmdPtr &cmd, CmdTemplate *&tmpl)
+        { tmpl = NULL; return Next(cmd); }
+
+    /**
+     * Notification that a cmd handed out by Next() has completed with the
+     * expected status; its CE has been validated but not yet discarded.
+     * @param cmd Pass the cmd which completed
+     * @param tmpl Pass the template NextTemplate() returned, otherwise NULL
+     * @param ce Pass the CE which completed the cmd
+     */
+    virtual void Completed(SharedCmdPtr cmd, CmdTemplate *tmpl,
+        const union CE &ce)
+        { (void)cmd; (void)tmpl; (void)ce; }
+};
+
+
 /**
 * This class is meant not be instantiated because it should only ever contain
 * static members. These utility functions can be viewed as wrappers to
@@ -44,6 +85,8 @@ public:
      * also assume no other cmd will complete into that CQ while this operation
      * is occurring. In the end the number of CE's will be verified to
      * guarantee that only 1 CE arrived as a result of sending this 1 cmd.
+     * While an AERService is running against the CQ, the cmd is instead
+     * handed to AERService::SendAndReapCmd() and the CQ need not be empty.
      * @note Throws upon errors
      * @note Method uses pre-existing values of CC.IOCQES
      * @param grpName Pass the name of the group to which this test belongs
@@ -64,6 +107,16 @@ public:
         SharedSQPtr sq, SharedCQPtr cq, SharedCmdPtr cmd, string qualify,
         bool verbose, std::vector<CEStat> &status);
 
+    /**
+     * Identical to SendAndReapCmd() above, except the cmd of a template is
+     * sent via SQ::SendTemplate(). Intended for loops which repeatedly
+     * resubmit the same cmd, only patching its SLBA and NLB.
+     * @param tmpl Pass the template of the cmd to issue into the supplied SQ
+     */
+    static CEStat SendAndReapCmd(string grpName, string testName, uint16_t ms,
+        SharedSQPtr sq, SharedCQPtr cq, CmdTemplate &tmpl, string qualify,
+        bool verbose, CEStat status = CESTAT_SUCCESS);
+
     /**
      * Reap a specified number of CE's from the specified CQ.
      * @note Throws upon errors
@@ -83,7 +136,38 @@ public:
         string grpName, string testName, string qualify,
         std::vector<CEStat> &status);
 
+    /**
+     * Send all the cmds supplied by a generator to hdw using the spec'd SQ/CQ
+     * pair, while keeping up to qDepth cmds outstanding at any time. CE's are
+     * matched back to their cmd by a CEDispatcher keyed by (SQID, CID), thus
+     * they may complete in any order.
+     * This method requires 0 elements to reside in the CQ and also assumes
+     * no other cmd will complete into that CQ while this operation is
+     * occurring.
+     * @note Throws upon errors, dumping the CQ and offending cmd similarly to
+     *       SendAndReapCmd().
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     * @param ms Pass the max number of ms to wait for any outstanding CE
+     * @param sq Pass pre-existing SQ to issue the cmds into
+     * @param cq Pass pre-existing CQ to reap the CE's from
+     * @param gen Pass the supplier of the cmds to issue
+     * @param qDepth Pass the max number of cmds to keep outstanding; it will
+     *      be reduced to what the SQ and CQ can hold if necessary.
+     * @param qualify Pass a qualifying string to append to each dump file
+     * @param verbose Pass true to dump each cmd after it completes
+     * @param status Pass the expected status to verify every CE with
+     * @return The number of cmds which completed
+     */
+    static uint64_t Pipeline(string grpName, string testName, uint16_t ms,
+        SharedSQPtr sq, SharedCQPtr cq, CmdGenerator &gen, uint32_t qDepth,
+        string qualify, bool verbose, CEStat status = CESTAT_SUCCESS);
+
 private:
+    /// Implements all the SendAndReapCmd() flavors, tmpl may be NULL
+    static CEStat SendAndReap(string grpName, string testName, uint16_t ms,
+        SharedSQPtr sq, SharedCQPtr cq, SharedCmdPtr cmd, CmdTemplate *tmpl,
+        string qualify, bool verbose, std::vector<CEStat> &status);
 };
 
 
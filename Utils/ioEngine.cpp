@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <sched.h>
+#include <unistd.h>
+#include <boost/format.hpp>
+#include "ioEngine.h"
+
+
+IOEngine::IOEngine()
+{
+    // This constructor will throw
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+IOEngine::IOEngine(string grpName, string testName)
+{
+    mGrpName = grpName;
+    mTestName = testName;
+    mAbort = 0;
+}
+
+
+IOEngine::~IOEngine()
+{
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        // Never leave a thread running against a worker about to be deleted
+        if (mWorkers[i]->started) {
+            __sync_lock_test_and_set(&mAbort, 1);
+            pthread_join(mWorkers[i]->thread, NULL);
+        }
+        delete mWorkers[i];
+    }
+}
+
+
+void
+IOEngine::AddWorker(SharedSQPtr sq, SharedCQPtr cq, CmdGenerator &gen,
+    uint32_t qDepth, uint16_t ms)
+{
+    if (sq->GetCqId() != cq->GetQId()) {
+        throw FrmwkEx(HERE, "SQ %d is not associated with CQ %d",
+            sq->GetQId(), cq->GetQId());
+    }
+
+    Worker *worker = new Worker();
+    worker->engine = this;
+    worker->id = mWorkers.size();
+    worker->sq = sq;
+    worker->cq = cq;
+    worker->gen = &gen;
+    worker->qDepth = qDepth;
+    worker->ms = ms;
+    worker->started = false;
+    worker->failed = false;
+    worker->numCmds = 0;
+    mWorkers.push_back(worker);
+    LOG_NRM("IO engine worker %d drives (SQ,CQ) = (%d,%d) at QD %d",
+        worker->id, sq->GetQId(), cq->GetQId(), qDepth);
+}
+
+
+void
+IOEngine::Start(bool pin)
+{
+    int rc;
+    long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (mWorkers.empty())
+        throw FrmwkEx(HERE, "IO engine has no workers to start");
+
+    LOG_NRM("Starting %ld IO engine workers", mWorkers.size());
+    mAbort = 0;
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        Worker *worker = mWorkers[i];
+        if (worker->started)
+            throw FrmwkEx(HERE, "IO engine worker %ld already started", i);
+
+        worker->failed = false;
+        worker->failure = "";
+        if ((rc = pthread_create(&worker->thread, NULL, WorkerMain,
+            worker)) != 0) {
+            __sync_lock_test_and_set(&mAbort, 1);
+            throw FrmwkEx(HERE, "Unable to create worker thread, rc=%d", rc);
+        }
+        worker->started = true;
+
+        if (pin && (numCpus > 0)) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET((i % numCpus), &cpus);
+            if (pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus))
+                LOG_WARN("Unable to pin IO engine worker %ld", i);
+        }
+    }
+}
+
+
+void
+IOEngine::Join()
+{
+    Worker *failure = NULL;
+
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        Worker *worker = mWorkers[i];
+        if (worker->started == false)
+            continue;
+
+        pthread_join(worker->thread, NULL);
+        worker->started = false;
+        if (worker->failed && (failure == NULL))
+            failure = worker;
+    }
+
+    LOG_NRM("IO engine workers completed %llu cmds",
+        (long long unsigned int)GetTotalCmds());
+    if (failure) {
+        throw FrmwkEx(HERE, "IO engine worker %d failed: %s", failure->id,
+            failure->failure.c_str());
+    }
+}
+
+
+uint64_t
+IOEngine::GetNumCmds(uint32_t worker)
+{
+    if (worker >= mWorkers.size())
+        throw FrmwkEx(HERE, "IO engine worker %d does not exist", worker);
+    return __sync_fetch_and_add(&mWorkers[worker]->numCmds, 0);
+}
+
+
+uint64_t
+IOEngine::GetTotalCmds()
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < mWorkers.size(); i++)
+        total += GetNumCmds(i);
+    return total;
+}
+
+
+void *
+IOEngine::WorkerMain(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    IOEngine *engine = worker->engine;
+    string qualify = str(boost::format("worker%d") % worker->id);
+
+    // Exceptions must not escape a thread, marshal them back to Join()
+    try {
+        IO::Pipeline(engine->mGrpName, engine->mTestName, worker->ms,
+            worker->sq, worker->cq, *worker, worker->qDepth, qualify, false);
+    } catch (FrmwkEx &ex) {
+        worker->failure = ex.GetMessage();
+        worker->failed = true;
+    } catch (...) {
+        worker->failure = "Unknown exception";
+        worker->failed = true;
+    }
+
+    if (worker->failed)
+        __sync_lock_test_and_set(&engine->mAbort, 1);
+    return NULL;
+}
+
+
+bool
+IOEngine::Worker::Next(SharedCmdPtr &cmd)
+{
+    // Stop issuing once any other worker fails; draining what's outstanding
+    if (__sync_fetch_and_add(&engine->mAbort, 0))
+        return false;
+    return gen->Next(cmd);
+}
+
+
+bool
+IOEngine::Worker::NextTemplate(SharedCmdPtr &cmd, CmdTemplate *&tmpl)
+{
+    if (__sync_fetch_and_add(&engine->mAbort, 0))
+        return false;
+    return gen->NextTemplate(cmd, tmpl);
+}
+
+
+void
+IOEngine::Worker::Completed(SharedCmdPtr cmd, CmdTemplate *tmpl,
+    const union CE &ce)
+{
+    gen->Completed(cmd, tmpl, ce);
+    __sync_fetch_and_add(&numCmds, 1);
+}
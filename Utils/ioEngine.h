@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _IOENGINE_H_
+#define _IOENGINE_H_
+
+#include <pthread.h>
+#include "tnvme.h"
+#include "io.h"
+
+
+/**
+* This class drives many SQ/CQ pairs concurrently by dedicating one worker
+* thread to each pair. Every worker runs its own IO::Pipeline() submission and
+* reap loop, only ever touching its own SQ, CQ and CmdGenerator, thus no
+* locking is required between workers. Progress is published through per
+* worker counters which may be read lock free at any time, allowing aggregate
+* IOPS to be sampled while the workers are running.
+*
+* All SQ/CQ pairs must be created before Start() and must outlive Join().
+* Any failure within a worker causes all remaining workers to stop issuing
+* new cmds; Join() rethrows the 1st failure from the calling thread.
+*
+* @note This class may throw exceptions.
+*/
+class IOEngine
+{
+public:
+    /**
+     * @param grpName Pass the name of the group to which this test belongs
+     * @param testName Pass the name of the child testclass
+     */
+    IOEngine(string grpName, string testName);
+    virtual ~IOEngine();
+
+    /**
+     * Add a worker to drive an SQ/CQ pair. The CQ must only be fed by the
+     * supplied SQ.
+     * @param sq Pass pre-existing SQ to issue the cmds into
+     * @param cq Pass pre-existing CQ to reap the CE's from
+     * @param gen Pass the supplier of the cmds to issue; it must only be
+     *      handed to a single worker.
+     * @param qDepth Pass the max number of cmds to keep outstanding
+     * @param ms Pass the max number of ms to wait for any outstanding CE
+     */
+    void AddWorker(SharedSQPtr sq, SharedCQPtr cq, CmdGenerator &gen,
+        uint32_t qDepth, uint16_t ms);
+
+    /**
+     * Launch a thread per worker added thus far.
+     * @param pin Pass true to pin worker N to CPU (N % number of CPU's)
+     */
+    void Start(bool pin = true);
+
+    /**
+     * Wait for all workers to exhaust their CmdGenerator. Throws if any
+     * worker failed.
+     */
+    void Join();
+
+    /// Start() and Join() in a single call
+    void Run(bool pin = true) { Start(pin); Join(); }
+
+    uint32_t GetNumWorkers() { return mWorkers.size(); }
+
+    /**
+     * Lock free read of the number of cmds which have completed successfully.
+     * @param worker Pass [0 to (GetNumWorkers()-1)]
+     * @return The number of cmds completed by the specified worker
+     */
+    uint64_t GetNumCmds(uint32_t worker);
+
+    /// @return The sum of GetNumCmds() across all workers
+    uint64_t GetTotalCmds();
+
+
+private:
+    IOEngine();
+
+    struct Worker : public CmdGenerator {
+        IOEngine *engine;
+        uint32_t id;
+        SharedSQPtr sq;
+        SharedCQPtr cq;
+        CmdGenerator *gen;
+        uint32_t qDepth;
+        uint16_t ms;
+        pthread_t thread;
+        bool started;
+        string failure;
+        bool failed;
+
+        // Keep the counters on a cache line of their own, workers on
+        // neighboring heap allocations would otherwise falsely share them.
+        uint8_t pad0[64];
+        uint64_t numCmds;
+        uint8_t pad1[64];
+
+        virtual bool Next(SharedCmdPtr &cmd);
+        virtual bool NextTemplate(SharedCmdPtr &cmd, CmdTemplate *&tmpl);
+        virtual void Completed(SharedCmdPtr cmd, CmdTemplate *tmpl,
+            const union CE &ce);
+    };
+
+    string mGrpName;
+    string mTestName;
+    vector<Worker *> mWorkers;
+    /// Set by the 1st failing worker to stop all others from issuing cmds
+    volatile int mAbort;
+
+    /// The thread entry point for every worker
+    static void *WorkerMain(void *arg);
+};
+
+
+#endif
@@ -20,8 +20,10 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
 #include "kernelAPI.h"
 #include "globals.h"
+#include "deferredDump.h"
 
 #define FILENAME_FLAGS         (O_RDWR | O_TRUNC | O_CREAT)
 #define FILENAME_MODE          (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)
@@ -67,11 +69,40 @@ void
 KernelAPI::DumpKernelMetrics(DumpFilename filename)
 {
     int rc;
-    struct nvme_file dumpMe = { filename.length(), filename.c_str() };
+    int fd;
+    string dumpFile = filename;
+    char tmpFile[] = "/dev/shm/tnvme.kmetrics.XXXXXX";
+
+    // dnvme only writes files; while deferring it writes a tmpfs file which
+    // is snapshot into memory, thus nothing reaches the disk.
+    if (DeferredDump::IsActive()) {
+        if ((fd = mkstemp(tmpFile)) >= 0) {
+            close(fd);
+            dumpFile = tmpFile;
+        }
+    }
 
-    LOG_NRM("Dump dnvme metrics to filename: %s", filename.c_str());
-    if ((rc = ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0)
+    struct nvme_file dumpMe = { dumpFile.length(), dumpFile.c_str() };
+    LOG_NRM("Dump dnvme metrics to filename: %s", dumpFile.c_str());
+    if ((rc = ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0) {
+        if (dumpFile != filename)
+            unlink(dumpFile.c_str());
         throw FrmwkEx(HERE, "Unable to dump dnvme metrics, err code = %d", rc);
+    }
+    if (dumpFile == filename)
+        return;
+
+    vector<uint8_t> metrics;
+    if ((fd = open(dumpFile.c_str(), O_RDONLY)) >= 0) {
+        uint8_t work[4096];
+        ssize_t len;
+        while ((len = read(fd, work, sizeof(work))) > 0)
+            metrics.insert(metrics.end(), work, (work + len));
+        close(fd);
+    }
+    unlink(dumpFile.c_str());
+    DeferredDump::Capture(filename, DeferredDump::RenderRaw,
+        (metrics.empty() ? NULL : &metrics[0]), metrics.size());
 }
 
 
@@ -81,34 +112,32 @@ KernelAPI::DumpCtrlrSpaceRegs(DumpFilename filename, bool verbose)
     int fd;
     string work;
     uint64_t value = 0;
-    string outFile;
+    RegSnapshot regs;
     const CtlSpcType *pciMetrics = gRegisters->GetCtlMetrics();
 
 
     LOG_NRM("Dump ctrlr regs to filename: %s", filename.c_str());
+    if (gRegisters->Snapshot(regs, verbose) == false)
+        throw FrmwkEx(HERE);
     if ((fd = open(filename.c_str(), FILENAME_FLAGS, FILENAME_MODE)) == -1)
         throw FrmwkEx(HERE, "file=%s: %s", filename.c_str(), strerror(errno));
 
-    // Read all registers in ctrlr space
+    // Decode all registers in ctrlr space
     for (int i = 0; i < CTLSPC_FENCE; i++) {
         if (pciMetrics[i].specRev != gRegisters->GetSpecRev())
             continue;
 
         if (pciMetrics[i].size > MAX_SUPPORTED_REG_SIZE) {
-            uint8_t *buffer;
-            buffer = new uint8_t[pciMetrics[i].size];
-            if (gRegisters->Read(NVMEIO_BAR01, pciMetrics[i].size,
-                pciMetrics[i].offset, buffer, verbose) == false) {
+            const uint8_t *buffer = regs.GetRaw((CtlSpc)i);
+            if (buffer == NULL)
                 goto ERROR_OUT;
-            } else {
-                string work = "  ";
-                work += gRegisters->FormatRegister(NVMEIO_BAR01,
-                    pciMetrics[i].size, pciMetrics[i].offset, buffer);
-                work += "\n";
-                write(fd, work.c_str(), work.size());
-            }
-            delete [] buffer;
-        } else if (gRegisters->Read((CtlSpc)i, value, verbose) == false) {
+
+            work = "  ";
+            work += gRegisters->FormatRegister(NVMEIO_BAR01,
+                pciMetrics[i].size, pciMetrics[i].offset, (uint8_t *)buffer);
+            work += "\n";
+            write(fd, work.c_str(), work.size());
+        } else if (regs.Get((CtlSpc)i, value) == false) {
             break;
         } else {
             work = "  ";    // indent reg values within each capability
@@ -134,11 +163,14 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
     int fd;
     string work;
     uint64_t value;
+    RegSnapshot regs;
     const PciSpcType *pciMetrics = gRegisters->GetPciMetrics();
     const vector<PciCapabilities> *pciCap = gRegisters->GetPciCapabilities();
 
 
     LOG_NRM("Dump PCI regs to filename: %s", filename.c_str());
+    if (gRegisters->Snapshot(regs, verbose) == false)
+        throw FrmwkEx(HERE);
     if ((fd = open(filename.c_str(), FILENAME_FLAGS, FILENAME_MODE)) == -1)
         throw FrmwkEx(HERE, "file=%s: %s", filename.c_str(), strerror(errno));
 
@@ -151,7 +183,7 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
 
         // All PCI hdr regs don't have an associated capability
         if (pciMetrics[j].cap == PCICAP_FENCE) {
-            if (gRegisters->Read((PciSpc)j, value, verbose) == false)
+            if (regs.Get((PciSpc)j, value) == false)
                 goto ERROR_OUT;
             RegToFile(fd, pciMetrics[j], value);
         }
@@ -183,32 +215,24 @@ KernelAPI::DumpPciSpaceRegs(DumpFilename filename, bool verbose)
         }
         write(fd, work.c_str(), work.size());
 
-        // Read all registers assoc with the discovered capability
+        // Decode all registers assoc with the discovered capability
         for (int j = 0; j < PCISPC_FENCE; j++) {
             if (pciMetrics[j].specRev != gRegisters->GetSpecRev())
                 continue;
 
             if (pciCap->at(i) == pciMetrics[j].cap) {
                 if (pciMetrics[j].size > MAX_SUPPORTED_REG_SIZE) {
-                    bool err = false;
-                    uint8_t *buffer;
-                    buffer = new uint8_t[pciMetrics[j].size];
-
-                    if (gRegisters->Read(NVMEIO_PCI_HDR, pciMetrics[j].size,
-                        pciMetrics[j].offset, buffer, verbose) == false) {
-                        err = true;
-                    } else {
-                        string work = "  ";
-                        work += gRegisters->FormatRegister(NVMEIO_PCI_HDR,
-                            pciMetrics[j].size, pciMetrics[j].offset, buffer);
-                        work += "\n";
-                        write(fd, work.c_str(), work.size());
-                    }
-                    delete [] buffer;
-                    if (err)
+                    const uint8_t *buffer = regs.GetRaw((PciSpc)j);
+                    if (buffer == NULL)
                         goto ERROR_OUT;
-                } else if (gRegisters->Read((PciSpc)j, value, verbose) ==
-                    false) {
+
+                    work = "  ";
+                    work += gRegisters->FormatRegister(NVMEIO_PCI_HDR,
+                        pciMetrics[j].size, pciMetrics[j].offset,
+                        (uint8_t *)buffer);
+                    work += "\n";
+                    write(fd, work.c_str(), work.size());
+                } else if (regs.Get((PciSpc)j, value) == false) {
                     goto ERROR_OUT;
                 } else {
                     RegToFile(fd, pciMetrics[j], value);
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include <stddef.h>
+#include "lbaTag.h"
+#include "globals.h"
+
+#if defined(__x86_64__)
+#define LBATAG_X86_64
+#endif
+
+/// CRC32C (Castagnoli) polynomial, bit reflected
+#define CRC32C_POLY         0x82F63B78
+
+
+LBATagReport::LBATagReport(uint32_t maxReport)
+{
+    mMaxReport = maxReport;
+    Clear();
+}
+
+
+void
+LBATagReport::Clear()
+{
+    for (int i = 0; i < BLKSTATE_FENCE; i++)
+        mNumBlks[i] = 0;
+    mBadBlks.clear();
+}
+
+
+void
+LBATagReport::Add(uint64_t lba, BlkState state, const LBATagHdr &found)
+{
+    mNumBlks[state]++;
+    if ((state != BLK_OK) && (mBadBlks.size() < mMaxReport)) {
+        BadBlk badBlk;
+        badBlk.lba = lba;
+        badBlk.state = state;
+        badBlk.found = found;
+        mBadBlks.push_back(badBlk);
+    }
+}
+
+
+void
+LBATagReport::Log() const
+{
+    const char *stateStr[] =
+        { "ok", "stale", "future", "misplaced", "corrupt" };
+
+    LOG_NRM("LBA tagged blks: %llu ok, %llu stale, %llu future, "
+        "%llu misplaced, %llu corrupt", (unsigned long long)mNumBlks[BLK_OK],
+        (unsigned long long)mNumBlks[BLK_STALE],
+        (unsigned long long)mNumBlks[BLK_FUTURE],
+        (unsigned long long)mNumBlks[BLK_MISPLACED],
+        (unsigned long long)mNumBlks[BLK_CORRUPT]);
+    for (size_t i = 0; i < mBadBlks.size(); i++) {
+        const BadBlk &bad = mBadBlks[i];
+        LOG_ERR("  LBA 0x%016llX %s: found (nsid,lba,gen) = "
+            "(%d,0x%016llX,%u)", (unsigned long long)bad.lba,
+            stateStr[bad.state], bad.found.nsid,
+            (unsigned long long)bad.found.lba, bad.found.gen);
+    }
+}
+
+
+LBATag::LBATag()
+{
+}
+
+
+LBATag::~LBATag()
+{
+}
+
+
+static uint32_t
+CRC32CSoft(uint32_t crc, const uint8_t *buf, size_t length)
+{
+    // The table never changes once built, racing to build it is harmless
+    static uint32_t table[256];
+    static bool tableBuilt = false;
+
+    if (tableBuilt == false) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t entry = i;
+            for (int bit = 0; bit < 8; bit++)
+                entry = ((entry >> 1) ^ ((entry & 1) ? CRC32C_POLY : 0));
+            table[i] = entry;
+        }
+        tableBuilt = true;
+    }
+
+    for (size_t i = 0; i < length; i++)
+        crc = ((crc >> 8) ^ table[(crc ^ buf[i]) & 0xff]);
+    return crc;
+}
+
+
+#ifdef LBATAG_X86_64
+__attribute__((target("sse4.2"))) static uint32_t
+CRC32CHard(uint32_t crc, const uint8_t *buf, size_t length)
+{
+    uint64_t crc64 = crc;
+    size_t i = 0;
+
+    for (; (i + sizeof(uint64_t)) <= length; i += sizeof(uint64_t)) {
+        uint64_t data;
+        memcpy(&data, (buf + i), sizeof(data));
+        crc64 = __builtin_ia32_crc32di(crc64, data);
+    }
+    crc = (uint32_t)crc64;
+    for (; i < length; i++)
+        crc = __builtin_ia32_crc32qi(crc, buf[i]);
+    return crc;
+}
+#endif
+
+
+uint32_t
+LBATag::CRC32C(uint32_t crc, const uint8_t *buf, size_t length)
+{
+#ifdef LBATAG_X86_64
+    // The CPU never changes, thus probe it only once
+    static int hard = -1;
+    if (hard < 0) {
+        __builtin_cpu_init();
+        hard = (__builtin_cpu_supports("sse4.2") ? 1 : 0);
+    }
+    if (hard)
+        return ~CRC32CHard(~crc, buf, length);
+#endif
+    return ~CRC32CSoft(~crc, buf, length);
+}
+
+
+uint32_t
+LBATag::CalcBlkCRC(const uint8_t *blk, uint32_t blkSize)
+{
+    const uint32_t crcOffset = offsetof(LBATagHdr, crc);
+    const uint32_t zero = 0;
+
+    uint32_t crc = CRC32C(0, blk, crcOffset);
+    crc = CRC32C(crc, (const uint8_t *)&zero, sizeof(zero));
+    return CRC32C(crc, (blk + crcOffset + sizeof(zero)),
+        (blkSize - crcOffset - sizeof(zero)));
+}
+
+
+void
+LBATag::Fill(uint8_t *buf, uint32_t blkSize, uint32_t numBlks, uint32_t nsid,
+    uint64_t slba, uint32_t gen)
+{
+    if ((blkSize % sizeof(uint64_t)) || (blkSize <= sizeof(LBATagHdr)))
+        throw FrmwkEx(HERE, "Illegal LBA tagged blk size: %d", blkSize);
+
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        uint8_t *blkPtr = (buf + ((uint64_t)blk * blkSize));
+        LBATagHdr hdr;
+        hdr.magic = LBATAG_MAGIC;
+        hdr.nsid = nsid;
+        hdr.lba = (slba + blk);
+        hdr.gen = gen;
+        hdr.crc = 0;
+        memcpy(blkPtr, &hdr, sizeof(hdr));
+
+        // xorshift64, seeded by a splitmix64 finalization of the identity of
+        // the blk, never seed with 0 which would only ever yield 0
+        uint64_t x = (hdr.lba ^ ((uint64_t)nsid << 32) ^
+            ((uint64_t)gen * 0x9E3779B97F4A7C15ULL));
+        x = ((x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL);
+        x = ((x ^ (x >> 27)) * 0x94D049BB133111EBULL);
+        x ^= (x >> 31);
+        if (x == 0)
+            x = LBATAG_MAGIC;
+        for (uint32_t i = sizeof(hdr); i < blkSize; i += sizeof(x)) {
+            x ^= (x << 13);
+            x ^= (x >> 7);
+            x ^= (x << 17);
+            memcpy((blkPtr + i), &x, sizeof(x));
+        }
+
+        hdr.crc = CalcBlkCRC(blkPtr, blkSize);
+        memcpy((blkPtr + offsetof(LBATagHdr, crc)), &hdr.crc,
+            sizeof(hdr.crc));
+    }
+}
+
+
+bool
+LBATag::Verify(const uint8_t *buf, uint32_t blkSize, uint32_t numBlks,
+    uint32_t nsid, uint64_t slba, uint32_t gen, LBATagReport &report)
+{
+    bool allOK = true;
+
+    if ((blkSize % sizeof(uint64_t)) || (blkSize <= sizeof(LBATagHdr)))
+        throw FrmwkEx(HERE, "Illegal LBA tagged blk size: %d", blkSize);
+
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        const uint8_t *blkPtr = (buf + ((uint64_t)blk * blkSize));
+        uint64_t lba = (slba + blk);
+        LBATagHdr found;
+        memcpy(&found, blkPtr, sizeof(found));
+
+        // The CRC covers the whole blk, thus intact blks need no regenerating
+        LBATagReport::BlkState state;
+        if ((found.magic != LBATAG_MAGIC) ||
+            (found.crc != CalcBlkCRC(blkPtr, blkSize))) {
+            state = LBATagReport::BLK_CORRUPT;
+        } else if ((found.nsid != nsid) || (found.lba != lba)) {
+            state = LBATagReport::BLK_MISPLACED;
+        } else if ((int32_t)(found.gen - gen) < 0) {
+            state = LBATagReport::BLK_STALE;
+        } else if (found.gen != gen) {
+            state = LBATagReport::BLK_FUTURE;
+        } else {
+            state = LBATagReport::BLK_OK;
+        }
+
+        report.Add(lba, state, found);
+        if (state != LBATagReport::BLK_OK)
+            allOK = false;
+    }
+    return allOK;
+}
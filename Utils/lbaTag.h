@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _LBATAG_H_
+#define _LBATAG_H_
+
+#include "tnvme.h"
+
+
+/**
+* Every logical blk of an LBA tagged pattern begins with this header.
+*/
+struct LBATagHdr {
+    uint32_t magic;             // LBATAG_MAGIC
+    uint32_t nsid;              // namspc the blk was written to
+    uint64_t lba;               // LBA the blk was written to
+    uint32_t gen;               // write generation of the blk
+    uint32_t crc;               // CRC32C of the entire blk, this field as 0
+} __attribute__((__packed__));
+
+#define LBATAG_MAGIC            0x5441424C      // "LBAT"
+
+
+/**
+* Collects the results of verifying LBA tagged blks. Every blk is counted by
+* its state, but only the details of the 1st few bad blks are retained.
+*/
+class LBATagReport
+{
+public:
+    /// The states of a blk which verification can discern
+    typedef enum {
+        BLK_OK,                 // blk is exactly what was expected
+        BLK_STALE,              // intact and in place, but an older generation
+        BLK_FUTURE,             // intact and in place, but a newer generation
+        BLK_MISPLACED,          // intact, but belongs to another NSID/LBA
+        BLK_CORRUPT,            // not intact, i.e. bad magic or CRC
+        BLKSTATE_FENCE          // always must be last element
+    } BlkState;
+
+    struct BadBlk {
+        uint64_t lba;           // LBA which was verified
+        BlkState state;
+        LBATagHdr found;        // header found within the blk
+    };
+
+    /**
+     * @param maxReport Pass the max number of bad blks to retain details of
+     */
+    LBATagReport(uint32_t maxReport = 16);
+    virtual ~LBATagReport() {}
+
+    /// Forget all prior results
+    void Clear();
+
+    void Add(uint64_t lba, BlkState state, const LBATagHdr &found);
+
+    /// @return The total number of blks verified to be in the state
+    uint64_t GetNumBlks(BlkState state) const { return mNumBlks[state]; }
+    /// @return The details of the 1st bad blks, in order of LBA
+    const vector<BadBlk> &GetBadBlks() const { return mBadBlks; }
+
+    /// Log a summary of all blks verified and the details of the bad blks
+    void Log() const;
+
+
+private:
+    uint32_t mMaxReport;
+    uint64_t mNumBlks[BLKSTATE_FENCE];
+    vector<BadBlk> mBadBlks;
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It generates and verifies a self describing data pattern in
+* which every logical blk embeds the NSID and LBA it was written to, a write
+* generation counter and a CRC32C of the entire blk, see LBATagHdr. The rest
+* of each blk is filled by an xorshift generator seeded from its NSID, LBA and
+* generation. The pattern is stateless, a blk can be verified knowing only
+* where it was read from and which generation ought to be there, thus the
+* buffer which was written is never needed. A single pass over each blk tells
+* whether the data is good, stale, from a future generation, misplaced or
+* corrupt. Generations are compared modulo 2^32, thus they may wrap.
+*
+* @note This class may throw exceptions.
+*/
+class LBATag
+{
+public:
+    /**
+     * Write the pattern for a run of consecutive logical blks.
+     * @param buf Pass the memory to write, it must hold (blkSize * numBlks)
+     * @param blkSize Pass the LBA data size, a multiple of 8 bytes which is
+     *      larger than LBATagHdr.
+     * @param numBlks Pass the number of logical blks
+     * @param nsid Pass the NSID the blks will be written to
+     * @param slba Pass the LBA the 1st blk will be written to
+     * @param gen Pass the write generation to embed
+     */
+    static void Fill(uint8_t *buf, uint32_t blkSize, uint32_t numBlks,
+        uint32_t nsid, uint64_t slba, uint32_t gen);
+
+    /**
+     * Verify a run of consecutive logical blks contain the pattern.
+     * @param buf Pass the memory to verify
+     * @param blkSize Pass the LBA data size
+     * @param numBlks Pass the number of logical blks
+     * @param nsid Pass the NSID the blks were read from
+     * @param slba Pass the LBA the 1st blk was read from
+     * @param gen Pass the write generation expected
+     * @param report Returns the results of every blk, it is not cleared
+     * @return true if every blk is BLK_OK, otherwise false
+     */
+    static bool Verify(const uint8_t *buf, uint32_t blkSize, uint32_t numBlks,
+        uint32_t nsid, uint64_t slba, uint32_t gen, LBATagReport &report);
+
+    /**
+     * Calculate a CRC32C (Castagnoli), using SSE4.2 when the CPU supports it.
+     * @param crc Pass 0 to start, or the result of a prior call to continue
+     * @param buf Pass the data to checksum
+     * @param length Pass the number of bytes to checksum
+     * @return The CRC32C of all data checksummed thus far
+     */
+    static uint32_t CRC32C(uint32_t crc, const uint8_t *buf, size_t length);
+
+
+private:
+    LBATag();
+    virtual ~LBATag();
+
+    /// @return The CRC32C of a blk, treating its LBATagHdr.crc as 0
+    static uint32_t CalcBlkCRC(const uint8_t *blk, uint32_t blkSize);
+};
+
+
+#endif
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <vector>
+#include "logger.h"
+
+/// Lines formatted on the stack up to this length, longer ones on the heap
+#define LOG_LINE_BYTES          1024
+/// The writer concatenates at most this many bytes per fwrite()
+#define LOG_BATCH_BYTES         (64 * 1024)
+/// The writer sleeps this long whenever it finds the ring empty
+#define LOG_IDLE_US             200
+#define LOG_FLUSH_POLL_US       50
+/// A signal handler waits no longer than this for the ring to be drained
+#define LOG_SIGNAL_WAIT_US      (500 * 1000)
+
+volatile int Logger::mLevel[LOGSUB_FENCE] = {
+    LOGLVL_NRM, LOGLVL_NRM, LOGLVL_NRM, LOGLVL_NRM };
+volatile LogFlush Logger::mPolicy = LOGFLUSH_ERR;
+volatile bool Logger::mRunning = false;
+volatile bool Logger::mStop = false;
+FILE *Logger::mOut = stderr;
+Logger::Slot *Logger::mRing = NULL;
+volatile uint64_t Logger::mHead = 0;
+volatile uint64_t Logger::mWritten = 0;
+pthread_t Logger::mThread;
+
+static const char *gLevelNames[] = { "err", "warn", "nrm", "dbg" };
+static const char *gSubsysNames[] = { "general", "queues", "regs", "cmds" };
+
+
+Logger::Logger()
+{
+}
+
+
+Logger::~Logger()
+{
+}
+
+
+bool
+Logger::Start(FILE *out)
+{
+    static bool hooked = false;
+    const int fatal[] = { SIGSEGV, SIGBUS, SIGFPE, SIGABRT, SIGINT, SIGTERM };
+
+    if (mRunning)
+        return true;
+
+    mOut = out;
+    if (mRing == NULL)
+        mRing = new Slot[LOG_RING_SLOTS];
+    for (uint64_t i = 0; i < LOG_RING_SLOTS; i++)
+        mRing[i].seq = i;
+    mHead = 0;
+    mWritten = 0;
+    mStop = false;
+    if (pthread_create(&mThread, NULL, Writer, NULL) != 0)
+        return false;
+    mRunning = true;
+
+    if (hooked == false) {
+        hooked = true;
+        atexit(AtExit);
+        for (size_t i = 0; i < (sizeof(fatal) / sizeof(fatal[0])); i++)
+            signal(fatal[i], SignalHandler);
+    }
+    return true;
+}
+
+
+void
+Logger::Stop()
+{
+    if (mRunning == false)
+        return;
+
+    mStop = true;
+    pthread_join(mThread, NULL);
+    mRunning = false;
+    fflush(mOut);
+}
+
+
+void
+Logger::Flush()
+{
+    if (mRunning == false) {
+        fflush(mOut);
+        return;
+    }
+
+    uint64_t target = mHead;
+    while (mWritten < target)
+        usleep(LOG_FLUSH_POLL_US);
+}
+
+
+void
+Logger::Failure()
+{
+    if (mPolicy != LOGFLUSH_LAZY)
+        Flush();
+}
+
+
+void
+Logger::SetLevel(LogSubsys sub, LogLevel lvl)
+{
+    if ((sub < LOGSUB_FENCE) && (lvl < LOGLVL_FENCE))
+        mLevel[sub] = lvl;
+}
+
+
+void
+Logger::SetFlushPolicy(LogFlush policy)
+{
+    if (policy >= LOGFLUSH_FENCE)
+        return;
+
+    // Lines queued under the previous policy must not be overtaken
+    if (policy == LOGFLUSH_SYNC)
+        Flush();
+    mPolicy = policy;
+}
+
+
+LogLevel
+Logger::GetLevel(string name)
+{
+    for (int i = 0; i < LOGLVL_FENCE; i++) {
+        if (name.compare(gLevelNames[i]) == 0)
+            return (LogLevel)i;
+    }
+    return LOGLVL_FENCE;
+}
+
+
+LogSubsys
+Logger::GetSubsys(string name)
+{
+    for (int i = 0; i < LOGSUB_FENCE; i++) {
+        if (name.compare(gSubsysNames[i]) == 0)
+            return (LogSubsys)i;
+    }
+    return LOGSUB_FENCE;
+}
+
+
+void
+Logger::Log(LogLevel lvl, const char *fmt, ...)
+{
+    char line[LOG_LINE_BYTES];
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len < 0)
+        return;
+
+    if ((size_t)len < sizeof(line)) {
+        if (mRunning && (mPolicy != LOGFLUSH_SYNC))
+            Enqueue(line, len);
+        else
+            WriteSync(line, len);
+    } else {
+        vector<char> bigLine(len + 1);
+        va_start(args, fmt);
+        vsnprintf(&bigLine[0], bigLine.size(), fmt, args);
+        va_end(args);
+        if (mRunning && (mPolicy != LOGFLUSH_SYNC))
+            Enqueue(&bigLine[0], len);
+        else
+            WriteSync(&bigLine[0], len);
+    }
+
+    if (lvl == LOGLVL_ERR)
+        Failure();
+}
+
+
+void
+Logger::Enqueue(const char *text, size_t len)
+{
+    uint64_t numSlots = ((len + LOG_SLOT_TEXT - 1) / LOG_SLOT_TEXT);
+
+    if (numSlots > LOG_RING_SLOTS) {
+        WriteSync(text, len);
+        return;
+    }
+
+    // Reserving all slots with 1 atomic op keeps the line contiguous
+    uint64_t ticket = __sync_fetch_and_add(&mHead, numSlots);
+    for (uint64_t i = 0; i < numSlots; i++, ticket++) {
+        Slot &slot = mRing[ticket & (LOG_RING_SLOTS - 1)];
+
+        // Ring is full, wait for the writer to free this slot
+        while (slot.seq != ticket)
+            sched_yield();
+
+        slot.len = ((len < LOG_SLOT_TEXT) ? len : LOG_SLOT_TEXT);
+        memcpy(slot.text, text, slot.len);
+        text += slot.len;
+        len -= slot.len;
+        __sync_synchronize();
+        slot.seq = (ticket + 1);
+    }
+}
+
+
+void
+Logger::WriteSync(const char *text, size_t len)
+{
+    // Lines already queued must be written 1st to preserve ordering
+    if (mRunning)
+        Flush();
+    fwrite(text, 1, len, mOut);
+}
+
+
+void *
+Logger::Writer(void *)
+{
+    char *batch = new char[LOG_BATCH_BYTES];
+    size_t batchLen = 0;
+    uint64_t tail = 0;
+
+    while (true) {
+        Slot &slot = mRing[tail & (LOG_RING_SLOTS - 1)];
+
+        if (slot.seq == (tail + 1)) {
+            __sync_synchronize();
+            if ((batchLen + slot.len) > LOG_BATCH_BYTES) {
+                fwrite(batch, 1, batchLen, mOut);
+                batchLen = 0;
+                mWritten = tail;
+            }
+            memcpy((batch + batchLen), slot.text, slot.len);
+            batchLen += slot.len;
+            __sync_synchronize();
+            slot.seq = (tail + LOG_RING_SLOTS);   // free for reuse
+            tail++;
+            continue;
+        }
+
+        // Caught up with the producers, write what has been gathered
+        if (batchLen) {
+            fwrite(batch, 1, batchLen, mOut);
+            fflush(mOut);
+            batchLen = 0;
+        }
+        mWritten = tail;
+        if (mStop && (tail == mHead))
+            break;
+        usleep(LOG_IDLE_US);
+    }
+
+    delete [] batch;
+    return NULL;
+}
+
+
+void
+Logger::SignalHandler(int sig)
+{
+    // Best effort to not lose the lines leading up to the fatal event. The
+    // signal may have interrupted a producer which reserved slots but never
+    // published them, thus Flush() could wait forever. Only wait for the
+    // slots already published ahead of the 1st unpublished one, and only
+    // for so long.
+    if (mRunning && (pthread_equal(pthread_self(), mThread) == 0)) {
+        uint64_t head = mHead;
+        uint64_t target = mWritten;
+        while ((target < head) &&
+            (mRing[target & (LOG_RING_SLOTS - 1)].seq > target)) {
+            target++;
+        }
+
+        struct timespec poll = { 0, (LOG_FLUSH_POLL_US * 1000) };
+        for (uint32_t waited = 0; (mWritten < target) &&
+            (waited < LOG_SIGNAL_WAIT_US); waited += LOG_FLUSH_POLL_US) {
+            nanosleep(&poll, NULL);
+        }
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+
+void
+Logger::AtExit()
+{
+    Stop();
+}
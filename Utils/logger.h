@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _LOGGER_H_
+#define _LOGGER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+
+using namespace std;
+
+
+typedef enum {
+    LOGLVL_ERR,
+    LOGLVL_WARN,
+    LOGLVL_NRM,
+    LOGLVL_DBG,
+    LOGLVL_FENCE                // always must be last element
+} LogLevel;
+
+typedef enum {
+    LOGSUB_GENERAL,             // everything not listed below
+    LOGSUB_QUEUES,              // Queues/
+    LOGSUB_REGS,                // Singletons/registers.cpp
+    LOGSUB_CMDS,                // Cmds/
+    LOGSUB_FENCE                // always must be last element
+} LogSubsys;
+
+typedef enum {
+    LOGFLUSH_LAZY,              // the writer thread drains at its own pace
+    LOGFLUSH_ERR,               // LOG_ERR's block until everything is written
+    LOGFLUSH_SYNC,              // every line is written before returning
+    LOGFLUSH_FENCE              // always must be last element
+} LogFlush;
+
+/// A Makefile may define the subsystem for all objects it builds
+#ifndef LOG_SUBSYS
+#define LOG_SUBSYS              LOGSUB_GENERAL
+#endif
+
+/// Number of slots in the ring, must be a power of 2
+#define LOG_RING_SLOTS          8192
+/// Bytes of text per slot, longer lines span consecutive slots
+#define LOG_SLOT_TEXT           240
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It is the backend of the LOG_xxx() macros. A line is
+* formatted by the thread logging it and then copied into a lock-free multi
+* producer ring; a background writer thread drains the ring, concatenating
+* lines and writing them with a single fwrite() per batch. Thus logging costs
+* the hot path a vsnprintf() and a memcpy() rather than a write syscall.
+* Should the ring fill the producer waits, no line is ever dropped.
+*
+* Lines are filtered by a runtime level per subsystem before they are even
+* formatted. The flush policy decides how much may remain queued when an
+* error is logged, e.g. by every FrmwkEx; regardless of policy the ring is
+* drained upon exit and upon fatal signals.
+*
+* Before Start() and after Stop() lines are written synchronously.
+*
+* @note This class will not throw exceptions.
+*/
+class Logger
+{
+public:
+    /**
+     * Spawn the writer thread and redirect all further logging through it.
+     * @param out Pass the stream to which lines are written
+     * @return true upon success, otherwise false and logging stays synchronous
+     */
+    static bool Start(FILE *out = stderr);
+
+    /// Drain the ring and join the writer thread
+    static void Stop();
+
+    /// Block until every line logged before this call has been written
+    static void Flush();
+
+    /**
+     * Indicate a failure was detected, flushing as dictated by the policy.
+     * LOGFLUSH_LAZY defers to the writer thread, otherwise this blocks
+     * until everything logged thus far has been written.
+     */
+    static void Failure();
+
+    /**
+     * @param sub Pass the subsystem to filter
+     * @param lvl Pass the most verbose level to be logged
+     */
+    static void SetLevel(LogSubsys sub, LogLevel lvl);
+    static void SetFlushPolicy(LogFlush policy);
+
+    /**
+     * Parse a level or subsystem name.
+     * @return The matching enum, or the FENCE value if unrecognized
+     */
+    static LogLevel GetLevel(string name);
+    static LogSubsys GetSubsys(string name);
+
+    /// @return true if a line of this level and subsystem is to be logged
+    static bool IsEnabled(LogLevel lvl, LogSubsys sub)
+        { return (lvl <= mLevel[sub]); }
+
+    /**
+     * Log a line, the caller must have checked IsEnabled().
+     * @param lvl Pass the level of the line being logged
+     * @param fmt Pass a printf() format string
+     */
+    static void Log(LogLevel lvl, const char *fmt, ...)
+        __attribute__((format(printf, 2, 3)));
+
+
+private:
+    Logger();
+    virtual ~Logger();
+
+    struct Slot {
+        volatile uint64_t seq;  // (ticket + 1) when full, ticket when free
+        uint16_t len;
+        char text[LOG_SLOT_TEXT];
+    };
+
+    static volatile int mLevel[LOGSUB_FENCE];
+    static volatile LogFlush mPolicy;
+    static volatile bool mRunning;
+    static volatile bool mStop;
+    static FILE *mOut;
+    static Slot *mRing;
+    static volatile uint64_t mHead;     // next ticket to hand to a producer
+    static volatile uint64_t mWritten;  // tickets handed to fwrite()
+    static pthread_t mThread;
+
+    /// Copy a formatted line into the ring
+    static void Enqueue(const char *text, size_t len);
+
+    /// Write a line bypassing the ring
+    static void WriteSync(const char *text, size_t len);
+
+    static void *Writer(void *arg);
+    static void SignalHandler(int sig);
+    static void AtExit();
+};
+
+
+#endif
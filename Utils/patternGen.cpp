@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include "patternGen.h"
+#include "globals.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PATTERNGEN_X86
+#endif
+
+#define ALWAYS_INLINE       inline __attribute__((always_inline))
+
+/// Verify() regenerates the expected pattern in chunks which stay in L1
+#define VERIFY_CHUNK_SIZE   4096
+
+
+PatternGen::PatternGen()
+{
+}
+
+
+PatternGen::~PatternGen()
+{
+}
+
+
+void
+MismatchReport::Add(uint32_t offset, uint64_t expected, uint64_t actual)
+{
+    mNumMismatches++;
+    if (mMismatches.size() < mMaxReport) {
+        Mismatch mismatch = { offset, expected, actual };
+        mMismatches.push_back(mismatch);
+    }
+}
+
+
+void
+MismatchReport::Log() const
+{
+    LOG_ERR("Detected %llu miscompared elements of %d bytes, 1st %ld:",
+        (unsigned long long)mNumMismatches, mElemSize, mMismatches.size());
+    for (size_t i = 0; i < mMismatches.size(); i++) {
+        LOG_ERR("  offset 0x%08X: expected 0x%0*llX, actual 0x%0*llX",
+            mMismatches[i].offset,
+            (mElemSize * 2), (unsigned long long)mMismatches[i].expected,
+            (mElemSize * 2), (unsigned long long)mMismatches[i].actual);
+    }
+}
+
+
+template <typename T>
+static ALWAYS_INLINE void
+FillConstScalar(T *dst, uint64_t count, T val)
+{
+    for (uint64_t i = 0; i < count; i++)
+        dst[i] = val;
+}
+
+
+template <typename T>
+static ALWAYS_INLINE void
+FillIncScalar(T *dst, uint64_t count, T initVal)
+{
+    for (uint64_t i = 0; i < count; i++)
+        dst[i] = initVal++;
+}
+
+
+/**
+ * Generic vector kernels; once inlined into a function compiled for a
+ * specific target the vector type maps directly onto its registers. Elements
+ * are stored unaligned, thus the buffer needs no particular alignment.
+ */
+template <typename T, int VBYTES>
+static ALWAYS_INLINE void
+FillConstVector(T *dst, uint64_t count, T val)
+{
+    typedef T Vec __attribute__((vector_size(VBYTES)));
+    const uint64_t LANES = (VBYTES / sizeof(T));
+
+    Vec v;
+    for (uint64_t i = 0; i < LANES; i++)
+        v[i] = val;
+
+    uint64_t i = 0;
+    for (; (i + LANES) <= count; i += LANES)
+        memcpy(dst + i, &v, sizeof(v));
+    FillConstScalar<T>(dst + i, (count - i), val);
+}
+
+
+template <typename T, int VBYTES>
+static ALWAYS_INLINE void
+FillIncVector(T *dst, uint64_t count, T initVal)
+{
+    typedef T Vec __attribute__((vector_size(VBYTES)));
+    const uint64_t LANES = (VBYTES / sizeof(T));
+
+    Vec v;
+    Vec step;
+    for (uint64_t i = 0; i < LANES; i++) {
+        v[i] = (T)(initVal + i);
+        step[i] = (T)LANES;
+    }
+
+    uint64_t i = 0;
+    for (; (i + LANES) <= count; i += LANES) {
+        memcpy(dst + i, &v, sizeof(v));
+        v += step;
+    }
+    FillIncScalar<T>(dst + i, (count - i), (T)(initVal + i));
+}
+
+
+static void
+FillScalar(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+    uint32_t length)
+{
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+        memset(buf, (uint8_t)initVal, length);
+        break;
+    case DATAPAT_CONST_16BIT:
+        FillConstScalar<uint16_t>((uint16_t *)buf, (length / 2), initVal);
+        break;
+    case DATAPAT_CONST_32BIT:
+        FillConstScalar<uint32_t>((uint32_t *)buf, (length / 4), initVal);
+        break;
+    case DATAPAT_INC_8BIT:
+        FillIncScalar<uint8_t>(buf, length, initVal);
+        break;
+    case DATAPAT_INC_16BIT:
+        FillIncScalar<uint16_t>((uint16_t *)buf, (length / 2), initVal);
+        break;
+    case DATAPAT_INC_32BIT:
+        FillIncScalar<uint32_t>((uint32_t *)buf, (length / 4), initVal);
+        break;
+    case DATAPAT_INC_64BIT:
+        FillIncScalar<uint64_t>((uint64_t *)buf, (length / 8), initVal);
+        break;
+    default:
+        throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+    }
+}
+
+
+#ifdef PATTERNGEN_X86
+template <int VBYTES>
+static ALWAYS_INLINE void
+FillVector(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+    uint32_t length)
+{
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+        // libc already selects the best implementation for the CPU
+        memset(buf, (uint8_t)initVal, length);
+        break;
+    case DATAPAT_CONST_16BIT:
+        FillConstVector<uint16_t, VBYTES>((uint16_t *)buf, (length / 2),
+            initVal);
+        break;
+    case DATAPAT_CONST_32BIT:
+        FillConstVector<uint32_t, VBYTES>((uint32_t *)buf, (length / 4),
+            initVal);
+        break;
+    case DATAPAT_INC_8BIT:
+        FillIncVector<uint8_t, VBYTES>(buf, length, initVal);
+        break;
+    case DATAPAT_INC_16BIT:
+        FillIncVector<uint16_t, VBYTES>((uint16_t *)buf, (length / 2),
+            initVal);
+        break;
+    case DATAPAT_INC_32BIT:
+        FillIncVector<uint32_t, VBYTES>((uint32_t *)buf, (length / 4),
+            initVal);
+        break;
+    case DATAPAT_INC_64BIT:
+        FillIncVector<uint64_t, VBYTES>((uint64_t *)buf, (length / 8),
+            initVal);
+        break;
+    default:
+        throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+    }
+}
+
+
+__attribute__((target("sse2"))) static void
+FillSSE2(DataPattern dataPat, uint64_t initVal, uint8_t *buf, uint32_t length)
+{
+    FillVector<16>(dataPat, initVal, buf, length);
+}
+
+
+__attribute__((target("avx2"))) static void
+FillAVX2(DataPattern dataPat, uint64_t initVal, uint8_t *buf, uint32_t length)
+{
+    FillVector<32>(dataPat, initVal, buf, length);
+}
+#endif
+
+
+void
+PatternGen::Fill(Kernel kernel, DataPattern dataPat, uint64_t initVal,
+    uint8_t *buf, uint32_t length)
+{
+    if (IsSupported(kernel) == false)
+        throw FrmwkEx(HERE, "Kernel %d is not supported by the CPU", kernel);
+
+    switch (kernel) {
+    case KERNEL_SCALAR:
+        FillScalar(dataPat, initVal, buf, length);
+        break;
+#ifdef PATTERNGEN_X86
+    case KERNEL_SSE2:
+        FillSSE2(dataPat, initVal, buf, length);
+        break;
+    case KERNEL_AVX2:
+        FillAVX2(dataPat, initVal, buf, length);
+        break;
+#endif
+    default:
+        throw FrmwkEx(HERE, "Unsupported kernel %d", kernel);
+    }
+}
+
+
+bool
+PatternGen::IsSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case KERNEL_SCALAR:
+        return true;
+#ifdef PATTERNGEN_X86
+    case KERNEL_SSE2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case KERNEL_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+
+uint8_t
+PatternGen::GetElementSize(DataPattern dataPat)
+{
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+    case DATAPAT_INC_8BIT:
+        return 1;
+    case DATAPAT_CONST_16BIT:
+    case DATAPAT_INC_16BIT:
+        return 2;
+    case DATAPAT_CONST_32BIT:
+    case DATAPAT_INC_32BIT:
+        return 4;
+    case DATAPAT_INC_64BIT:
+        return 8;
+    default:
+        throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+    }
+}
+
+
+bool
+PatternGen::Verify(DataPattern dataPat, uint64_t initVal, const uint8_t *buf,
+    uint32_t length, MismatchReport &report, uint32_t reportOffset)
+{
+    uint8_t expected[VERIFY_CHUNK_SIZE];
+    uint8_t elemSize = GetElementSize(dataPat);
+    bool incrementing = ((dataPat == DATAPAT_INC_8BIT) ||
+        (dataPat == DATAPAT_INC_16BIT) || (dataPat == DATAPAT_INC_32BIT) ||
+        (dataPat == DATAPAT_INC_64BIT));
+    Kernel kernel = GetKernel();
+
+    // Trailing bytes too few to hold a whole element are never written
+    length -= (length % elemSize);
+    report.Clear(elemSize);
+
+    // A const pattern is the same in every chunk, generate it only once
+    if (incrementing == false)
+        Fill(kernel, dataPat, initVal, expected, VERIFY_CHUNK_SIZE);
+
+    for (uint32_t pos = 0; pos < length; pos += VERIFY_CHUNK_SIZE) {
+        uint32_t chunk = MIN(VERIFY_CHUNK_SIZE, (length - pos));
+        if (incrementing) {
+            Fill(kernel, dataPat, (initVal + (pos / elemSize)), expected,
+                chunk);
+        }
+        if (memcmp(buf + pos, expected, chunk) == 0)
+            continue;
+
+        // Rare; pinpoint the offending elements of this chunk
+        for (uint32_t i = 0; i < chunk; i += elemSize) {
+            uint64_t exp = 0;
+            uint64_t act = 0;
+            memcpy(&exp, expected + i, elemSize);
+            memcpy(&act, buf + pos + i, elemSize);
+            if (exp != act)
+                report.Add((reportOffset + pos + i), exp, act);
+        }
+    }
+    return (report.GetNumMismatches() == 0);
+}
+
+
+PatternGen::Kernel
+PatternGen::GetKernel()
+{
+    // The CPU never changes, thus probe it only once
+    static Kernel kernel = KERNEL_FENCE;
+
+    if (kernel == KERNEL_FENCE) {
+        if (IsSupported(KERNEL_AVX2))
+            kernel = KERNEL_AVX2;
+        else if (IsSupported(KERNEL_SSE2))
+            kernel = KERNEL_SSE2;
+        else
+            kernel = KERNEL_SCALAR;
+    }
+    return kernel;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _PATTERNGEN_H_
+#define _PATTERNGEN_H_
+
+#include "tnvme.h"
+
+
+/**
+* Collects the mismatches detected while verifying a data pattern. Every
+* mismatching element is counted, but only the details of the 1st few are
+* retained.
+*/
+class MismatchReport
+{
+public:
+    struct Mismatch {
+        uint32_t offset;        // byte offset of the element within the buf
+        uint64_t expected;
+        uint64_t actual;
+    };
+
+    /**
+     * @param maxReport Pass the max number of mismatches to retain details of
+     */
+    MismatchReport(uint32_t maxReport = 16) :
+        mMaxReport(maxReport), mElemSize(1), mNumMismatches(0) {}
+    virtual ~MismatchReport() {}
+
+    /**
+     * Forget all prior mismatches.
+     * @param elemSize Pass the number of bytes in each element compared
+     */
+    void Clear(uint8_t elemSize = 1)
+        { mElemSize = elemSize; mNumMismatches = 0; mMismatches.clear(); }
+
+    void Add(uint32_t offset, uint64_t expected, uint64_t actual);
+
+    /// @return The total number of mismatching elements detected
+    uint64_t GetNumMismatches() const { return mNumMismatches; }
+    /// @return The details of the 1st mismatches, in order of offset
+    const vector<Mismatch> &GetMismatches() const { return mMismatches; }
+
+    /// Log the details of the retained mismatches
+    void Log() const;
+
+
+private:
+    uint32_t mMaxReport;
+    uint8_t mElemSize;
+    uint64_t mNumMismatches;
+    vector<Mismatch> mMismatches;
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It generates the data patterns defined by enum DataPattern
+* into raw memory. The const and incrementing patterns are generated by vector
+* kernels, the widest of which the CPU supports is selected at runtime, thus
+* generating a pattern costs little more than a memset() of the same length.
+*
+* @note This class may throw exceptions.
+*/
+class PatternGen
+{
+public:
+    /// The implementations which may be selected to generate patterns
+    typedef enum {
+        KERNEL_SCALAR,          // 1 element at a time, any CPU
+        KERNEL_SSE2,            // 16B at a time
+        KERNEL_AVX2,            // 32B at a time
+        KERNEL_FENCE            // always must be last element
+    } Kernel;
+
+    /**
+     * Write a data pattern to raw memory. The pattern starts with the stated
+     * initial value and progresses according to the desired pattern/series.
+     * Any trailing bytes too few to hold a whole element are not written.
+     * @param dataPat Pass the desired data pattern/series to calc next value
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param buf Pass the memory to write, no alignment is required
+     * @param length Pass the number of bytes to write
+     */
+    static void Fill(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+        uint32_t length) { Fill(GetKernel(), dataPat, initVal, buf, length); }
+
+    /**
+     * Same as the above, but forcing a specific kernel to be used.
+     * @param kernel Pass the kernel to use, it must be supported by the CPU
+     */
+    static void Fill(Kernel kernel, DataPattern dataPat, uint64_t initVal,
+        uint8_t *buf, uint32_t length);
+
+    /**
+     * Verify memory contains a data pattern, as written by Fill(), by
+     * regenerating the expected pattern a small chunk at a time and comparing
+     * in a single streaming pass, thus no copy of the expected data is needed.
+     * @param dataPat Pass the data pattern/series which is expected
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param buf Pass the memory to verify
+     * @param length Pass the number of bytes to verify
+     * @param report Returns the mismatches detected
+     * @param reportOffset Pass the value to add to every offset reported
+     * @return true if no mismatches were detected, otherwise false
+     */
+    static bool Verify(DataPattern dataPat, uint64_t initVal,
+        const uint8_t *buf, uint32_t length, MismatchReport &report,
+        uint32_t reportOffset = 0);
+
+    /// @return The number of bytes in each element of a data pattern
+    static uint8_t GetElementSize(DataPattern dataPat);
+
+    /// @return The widest kernel the CPU supports
+    static Kernel GetKernel();
+
+    /// @return true if the CPU supports the kernel
+    static bool IsSupported(Kernel kernel);
+
+
+private:
+    PatternGen();
+    virtual ~PatternGen();
+};
+
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "traceFmt.h"
+
+/// Indexed by TraceEvent; fmt's are identical to the LOG_NRM()'s replaced
+static const TraceEventDesc gEvents[TRC_FENCE] = {
+    { "sq_send", "sq.cpp",
+      "Send cmd opcode 0x%02X, payload size 0x%04X, to SQ id 0x%02X",
+      3, { "opcode", "payloadSize", "sqId" } },
+    { "sq_send_batch", "sq.cpp",
+      "Send batch of %ld cmds, 1st opcode 0x%02X, to SQ id 0x%02X",
+      3, { "numCmds", "opcode", "sqId" } },
+    { "sq_ring", "sq.cpp",
+      "Ring doorbell for SQ %d",
+      1, { "sqId" } },
+    { "cq_inquiry", "cq.cpp",
+      "%d CE's awaiting attention in CQ %d, ISR count: %d",
+      3, { "numCE", "cqId", "isrCount" } },
+    { "cq_waited", "cq.cpp",
+      "Waited for CE(s) approx: %d ms",
+      1, { "ms" } },
+    { "cq_reap", "cq.cpp",
+      "Reaped %d CE's, %d remain, from CQ %d, ISR count: %d",
+      4, { "numReaped", "numRemain", "cqId", "isrCount" } },
+    { "io_send", "io.cpp",
+      "Send the cmd to hdw via SQ %d",
+      1, { "sqId" } },
+    { "io_wait", "io.cpp",
+      "Wait for the CE to arrive in CQ %d",
+      1, { "cqId" } },
+    { "io_pipeline", "io.cpp",
+      "Pipeline cmds via SQ %d, CQ %d, QD %d",
+      3, { "sqId", "cqId", "qDepth" } },
+    { "io_pipeline_done", "io.cpp",
+      "Pipeline completed %ld cmds",
+      1, { "numDone" } },
+};
+
+
+TraceFmt::TraceFmt()
+{
+}
+
+
+TraceFmt::~TraceFmt()
+{
+}
+
+
+const TraceEventDesc *
+TraceFmt::GetEvent(uint16_t id)
+{
+    if (id >= TRC_FENCE)
+        return NULL;
+    return &gEvents[id];
+}
+
+
+string
+TraceFmt::Format(const char *fmt, const uint64_t *args, uint32_t numArgs)
+{
+    string out;
+    string spec;
+    char work[64];
+    uint32_t argIdx = 0;
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            out += *fmt++;
+            continue;
+        } else if (fmt[1] == '%') {
+            out += '%';
+            fmt += 2;
+            continue;
+        }
+
+        // Keep flags/width/precision, replace any length modifier w/ "ll"
+        spec = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.", *fmt))
+            spec += *fmt++;
+        while (*fmt && strchr("hlLqjzt", *fmt))
+            fmt++;
+        if (*fmt == '\0')
+            break;
+
+        char conv = *fmt++;
+        uint64_t val = (argIdx < numArgs) ? args[argIdx] : 0;
+        argIdx++;
+        spec += "ll";
+        spec += conv;
+        if ((conv == 'd') || (conv == 'i'))
+            snprintf(work, sizeof(work), spec.c_str(), (long long int)val);
+        else
+            snprintf(work, sizeof(work), spec.c_str(),
+                (long long unsigned int)val);
+        out += work;
+    }
+    return out;
+}
+
+
+string
+TraceFmt::RenderText(const TraceRec &rec)
+{
+    char work[64];
+    const TraceEventDesc *desc = GetEvent(rec.id);
+
+    if ((desc == NULL) || (rec.ns == 0))
+        return "";
+
+    snprintf(work, sizeof(work), "tnvme:%s:%d: ", desc->file, rec.line);
+    return (work + Format(desc->fmt, rec.arg, desc->numArgs));
+}
+
+
+string
+TraceFmt::RenderJSON(const TraceRec &rec)
+{
+    char work[128];
+    string out;
+    const TraceEventDesc *desc = GetEvent(rec.id);
+
+    if ((desc == NULL) || (rec.ns == 0))
+        return "";
+
+    snprintf(work, sizeof(work),
+        "{\"ns\":%llu,\"tid\":%u,\"event\":\"%s\",\"file\":\"%s\",\"line\":%u",
+        (long long unsigned int)rec.ns, rec.tid, desc->name, desc->file,
+        rec.line);
+    out = work;
+    for (uint32_t i = 0; i < desc->numArgs; i++) {
+        snprintf(work, sizeof(work), ",\"%s\":%llu", desc->argNames[i],
+            (long long unsigned int)rec.arg[i]);
+        out += work;
+    }
+    out += "}";
+    return out;
+}
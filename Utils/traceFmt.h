@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TRACEFMT_H_
+#define _TRACEFMT_H_
+
+#include <stdint.h>
+#include <string>
+
+using namespace std;
+
+/*
+ * This file is shared by tnvme and the standalone tnvme-trace decoder, thus
+ * it must not depend upon anything else within the framework.
+ */
+
+#define TRACE_MAGIC             "TNVMETRC"
+#define TRACE_VERSION           1
+#define TRACE_MAX_ARGS          4
+
+
+/// Every hot path event recorded in binary form, append only
+typedef enum {
+    TRC_SQ_SEND,
+    TRC_SQ_SEND_BATCH,
+    TRC_SQ_RING,
+    TRC_CQ_INQUIRY,
+    TRC_CQ_WAITED,
+    TRC_CQ_REAP,
+    TRC_IO_SEND,
+    TRC_IO_WAIT,
+    TRC_IO_PIPELINE,
+    TRC_IO_PIPELINE_DONE,
+    TRC_FENCE                   // always must be last element
+} TraceEvent;
+
+/// The trace file begins with this header, padded to a page
+struct TraceHdr {
+    char     magic[8];          // TRACE_MAGIC, w/o a terminating NULL
+    uint32_t version;           // TRACE_VERSION
+    uint32_t recSize;           // sizeof(TraceRec)
+    uint64_t numSlots;          // capacity of the ring of records, power of 2
+    volatile uint64_t numRecs;  // records ever written, > numSlots if wrapped
+    uint64_t startNs;           // CLOCK_MONOTONIC when tracing started
+};
+
+#define TRACE_HDR_SIZE          4096
+
+struct TraceRec {
+    uint64_t ns;                // CLOCK_MONOTONIC, 0 indicates never written
+    uint16_t id;                // TraceEvent
+    uint16_t line;              // source line of the event
+    uint32_t tid;               // tnvme assigned thread number
+    uint64_t arg[TRACE_MAX_ARGS];
+};
+
+/// Describes how to render an event, in the same text as its LOG_NRM() was
+struct TraceEventDesc {
+    const char *name;           // JSON identifier
+    const char *file;           // source file emitting the event
+    const char *fmt;            // printf() style fmt of integer conversions
+    uint32_t numArgs;
+    const char *argNames[TRACE_MAX_ARGS];
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It renders binary trace records back into text, either the
+* very same line which LOG_NRM() would have logged or a JSON object.
+*
+* @note This class will not throw exceptions.
+*/
+class TraceFmt
+{
+public:
+    /**
+     * @param id Pass the event ID to describe
+     * @return The description, or NULL if the ID is unknown
+     */
+    static const TraceEventDesc *GetEvent(uint16_t id);
+
+    /**
+     * Render a record as LOG_NRM() would have, w/o the trailing '\n'.
+     * @param rec Pass the record to render
+     * @return The text, empty if the record is not valid
+     */
+    static string RenderText(const TraceRec &rec);
+
+    /**
+     * Render a record as a single line JSON object.
+     * @param rec Pass the record to render
+     * @return The JSON text, empty if the record is not valid
+     */
+    static string RenderJSON(const TraceRec &rec);
+
+
+private:
+    TraceFmt();
+    virtual ~TraceFmt();
+
+    /// Substitute each conversion of fmt w/ the next integer of args
+    static string Format(const char *fmt, const uint64_t *args,
+        uint32_t numArgs);
+};
+
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "traceLog.h"
+#include "cmdLatency.h"
+
+int TraceLog::mFd = -1;
+uint64_t TraceLog::mMapSize = 0;
+TraceHdr *TraceLog::mHdr = NULL;
+TraceRec *TraceLog::mRecs = NULL;
+uint64_t TraceLog::mMask = 0;
+volatile uint32_t TraceLog::mNextTid = 0;
+
+/// Thread numbers are assigned upon a thread's 1st record, 0 = unassigned
+static __thread uint32_t tTid = 0;
+
+
+TraceLog::TraceLog()
+{
+}
+
+
+TraceLog::~TraceLog()
+{
+}
+
+
+bool
+TraceLog::Start(string filename, uint32_t sizeMiB)
+{
+    uint64_t numSlots = 1;
+    uint64_t maxSlots = (((uint64_t)sizeMiB * 1024 * 1024) / sizeof(TraceRec));
+
+    if (mHdr != NULL)
+        Stop();
+    if (maxSlots == 0) {
+        LOG_ERR("Trace file must hold at least 1 record");
+        return false;
+    }
+    while ((numSlots * 2) <= maxSlots)
+        numSlots *= 2;
+
+    mFd = open(filename.c_str(), (O_RDWR | O_CREAT | O_TRUNC), 0666);
+    if (mFd < 0) {
+        LOG_ERR("Unable to create trace file %s: %s", filename.c_str(),
+            strerror(errno));
+        return false;
+    }
+
+    // A sparse file, pages are only allocated as records reach them
+    mMapSize = (TRACE_HDR_SIZE + (numSlots * sizeof(TraceRec)));
+    if (ftruncate(mFd, mMapSize) != 0) {
+        LOG_ERR("Unable to size trace file %s: %s", filename.c_str(),
+            strerror(errno));
+        close(mFd);
+        mFd = -1;
+        return false;
+    }
+    void *map = mmap(NULL, mMapSize, (PROT_READ | PROT_WRITE), MAP_SHARED,
+        mFd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERR("Unable to map trace file %s: %s", filename.c_str(),
+            strerror(errno));
+        close(mFd);
+        mFd = -1;
+        return false;
+    }
+
+    TraceHdr *hdr = (TraceHdr *)map;
+    memcpy(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic));
+    hdr->version = TRACE_VERSION;
+    hdr->recSize = sizeof(TraceRec);
+    hdr->numSlots = numSlots;
+    hdr->numRecs = 0;
+    hdr->startNs = CmdLatency::Now();
+    mRecs = (TraceRec *)((uint8_t *)map + TRACE_HDR_SIZE);
+    mMask = (numSlots - 1);
+    mHdr = hdr;
+    LOG_NRM("Binary tracing to %s, ring of %llu records", filename.c_str(),
+        (long long unsigned int)numSlots);
+    return true;
+}
+
+
+void
+TraceLog::Stop()
+{
+    if (mHdr == NULL)
+        return;
+
+    TraceHdr *hdr = mHdr;
+    mHdr = NULL;
+    LOG_NRM("Binary tracing stopped after %llu records",
+        (long long unsigned int)hdr->numRecs);
+
+    // Drop the never reached tail of the ring
+    uint64_t used = MIN(hdr->numRecs, hdr->numSlots);
+    munmap(hdr, mMapSize);
+    if (ftruncate(mFd, (TRACE_HDR_SIZE + (used * sizeof(TraceRec)))) != 0)
+        LOG_WARN("Unable to truncate trace file: %s", strerror(errno));
+    close(mFd);
+    mFd = -1;
+    mRecs = NULL;
+}
+
+
+void
+TraceLog::Record(TraceEvent evt, uint16_t line, uint64_t a0, uint64_t a1,
+    uint64_t a2, uint64_t a3)
+{
+    if (tTid == 0)
+        tTid = __sync_add_and_fetch(&mNextTid, 1);
+
+    uint64_t idx = __sync_fetch_and_add(&mHdr->numRecs, 1);
+    TraceRec &rec = mRecs[idx & mMask];
+    rec.id = evt;
+    rec.line = line;
+    rec.tid = tTid;
+    rec.arg[0] = a0;
+    rec.arg[1] = a1;
+    rec.arg[2] = a2;
+    rec.arg[3] = a3;
+    rec.ns = CmdLatency::Now();
+}
+
+
+void
+TraceLog::Log(TraceEvent evt, uint16_t line, uint64_t a0, uint64_t a1,
+    uint64_t a2, uint64_t a3)
+{
+    TraceRec rec;
+
+    rec.ns = 1;
+    rec.id = evt;
+    rec.line = line;
+    rec.tid = 0;
+    rec.arg[0] = a0;
+    rec.arg[1] = a1;
+    rec.arg[2] = a2;
+    rec.arg[3] = a3;
+    Logger::Log(LOGLVL_NRM, "%s\n", TraceFmt::RenderText(rec).c_str());
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TRACELOG_H_
+#define _TRACELOG_H_
+
+#include "tnvme.h"
+#include "traceFmt.h"
+
+/**
+ * Record a hot path event, replacing the LOG_NRM() of the very same text.
+ * When binary tracing is not active the text is logged as it always was.
+ * @param evt Pass the TraceEvent
+ * @param ... Pass up to TRACE_MAX_ARGS integer arguments
+ */
+#define LOG_TRACE(evt, ...)                                     \
+    do {                                                        \
+        if (TraceLog::IsActive())                               \
+            TraceLog::Record(evt, __LINE__, ## __VA_ARGS__);    \
+        else if (Logger::IsEnabled(LOGLVL_NRM, LOG_SUBSYS))     \
+            TraceLog::Log(evt, __LINE__, ## __VA_ARGS__);       \
+    } while (0)
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It records hot path events as fixed size binary records,
+* an event ID plus raw integer arguments, into a memory mapped per run trace
+* file. Recording is a clock read, an atomic increment and a 48 byte store;
+* nothing is formatted and no syscall is made, cheap enough to be left on for
+* runs of millions of cmds. The file is a ring, once full the oldest records
+* are overwritten, and being a shared mapping its content survives a crash.
+* The tnvme-trace tool renders the file back to text or to JSON.
+*
+* @note This class will not throw exceptions.
+*/
+class TraceLog
+{
+public:
+    /**
+     * Create the trace file and start recording.
+     * @param filename Pass the name of the file to create
+     * @param sizeMiB Pass the size of the ring of records
+     * @return true upon success, otherwise false
+     */
+    static bool Start(string filename, uint32_t sizeMiB);
+
+    /// Stop recording, truncating the file to the records written
+    static void Stop();
+
+    static bool IsActive() { return (mHdr != NULL); }
+
+    /**
+     * Record an event, the caller must have checked IsActive().
+     * @param evt Pass the event to record
+     * @param line Pass the source line of the event
+     * @param a0 thru a3 Pass the event's arguments
+     */
+    static void Record(TraceEvent evt, uint16_t line, uint64_t a0 = 0,
+        uint64_t a1 = 0, uint64_t a2 = 0, uint64_t a3 = 0);
+
+    /// Log an event as text via LOG_NRM(), used when not recording
+    static void Log(TraceEvent evt, uint16_t line, uint64_t a0 = 0,
+        uint64_t a1 = 0, uint64_t a2 = 0, uint64_t a3 = 0);
+
+
+private:
+    TraceLog();
+    virtual ~TraceLog();
+
+    static int mFd;
+    static uint64_t mMapSize;
+    static TraceHdr *mHdr;
+    static TraceRec *mRecs;
+    static uint64_t mMask;
+    static volatile uint32_t mNextTid;
+};
+
+
+#endif
@@ -18,6 +18,13 @@
 #include "test.h"
 #include "globals.h"
 #include "./Utils/kernelAPI.h"
+#include "./Utils/cmdLatency.h"
+#include "./Utils/deferredDump.h"
+
+// The RW1C bits of the sticky error registers
+#define STS_STICKY_ERRS     (STS_DPD | STS_STA | STS_RTA | STS_RMA | \
+                             STS_SSE | STS_DPE)
+#define PXDS_STICKY_ERRS    (PXDS_CED | PXDS_NFED | PXDS_FED | PXDS_URD)
 
 
 Test::Test(string grpName, string testName, SpecRev specRev)
@@ -67,18 +74,28 @@ Test::operator=(const Test &other)
 bool
 Test::Run()
 {
+    bool pass = true;
+    RegSnapshot regsPre;
+    RegSnapshot regsPost;
+
+    // Dumps are only rendered if they will be of use, see DeferredDump
+    DeferredDump::Begin();
     try {
-        ResetStatusRegErrors();
+        gRegisters->Snapshot(regsPre);
+        if (ResetStatusRegErrors(regsPre))
+            gRegisters->Snapshot(regsPre);
         KernelAPI::DumpKernelMetrics(FileSystem::PrepDumpFile(mGrpName,
             mTestName, "kmetrics", "preTestRun"));
 
         RunCoreTest();  // Throws upon errors, returns upon success
 
         // What do the PCI registers say about errors that may have occurred?
-        if (GetStatusRegErrors() == false)
-            return false;
+        if ((gRegisters->Snapshot(regsPost) == false) ||
+            (GetStatusRegErrors(regsPost) == false)) {
+            pass = false;
+        }
     } catch (FrmwkEx &ex) {
-        return false;
+        pass = false;
     } catch (...) {
         // If this exception is thrown from some library which tnvme links
         // with then there is nothing that can be done about this. However,
@@ -90,9 +107,19 @@ Test::Run()
         LOG_ERR("*     see class note in file Exception/frmwkEx.h     *");
         LOG_ERR("******************************************************");
         LOG_ERR("******************************************************");
-        return false;
+        pass = false;
     }
-    return true;
+
+    // Which registers did the failing test leave changed?
+    if (pass == false) {
+        if (regsPost.IsValid() == false)
+            gRegisters->Snapshot(regsPost);
+        regsPre.LogDiff(regsPost);
+    }
+
+    DeferredDump::End((pass == false) || gCmdLine.postfail);
+    CmdLatency::LogTest(mGrpName + ":" + mTestName);
+    return pass;
 }
 
 
@@ -119,27 +146,42 @@ Test::Runnable(bool preserve)
 }
 
 
-void
-Test::ResetStatusRegErrors()
+bool
+Test::ResetStatusRegErrors(const RegSnapshot &regs)
 {
+    uint64_t value;
+    bool written = false;
     const vector<PciCapabilities> *cap = gRegisters->GetPciCapabilities();
 
     // The following algo is taking advantage of the fact that writing
-    // RO register bits have no effect, but will have effect on RWC bits
+    // RO register bits have no effect, but will have effect on RWC bits.
+    // Registers missing from the snapshot are reset regardless.
     LOG_NRM("Resetting sticky PCI errors");
-    gRegisters->Write(PCISPC_STS, 0xffff);
+    if ((regs.Get(PCISPC_STS, value) == false) || (value & STS_STICKY_ERRS)) {
+        gRegisters->Write(PCISPC_STS, 0xffff);
+        written = true;
+    }
 
     for (uint16_t i = 0; i < cap->size(); i++) {
-        if (cap->at(i) == PCICAP_PXCAP)
-            gRegisters->Write(PCISPC_PXDS, 0xffff);
-        else if (cap->at(i) == PCICAP_AERCAP)
-            gRegisters->Write(PCISPC_AERUCES, 0xffffffff);
+        if (cap->at(i) == PCICAP_PXCAP) {
+            if ((regs.Get(PCISPC_PXDS, value) == false) ||
+                (value & PXDS_STICKY_ERRS)) {
+                gRegisters->Write(PCISPC_PXDS, 0xffff);
+                written = true;
+            }
+        } else if (cap->at(i) == PCICAP_AERCAP) {
+            if ((regs.Get(PCISPC_AERUCES, value) == false) || value) {
+                gRegisters->Write(PCISPC_AERUCES, 0xffffffff);
+                written = true;
+            }
+        }
     }
+    return written;
 }
 
 
 bool
-Test::GetStatusRegErrors()
+Test::GetStatusRegErrors(const RegSnapshot &regs)
 {
     uint64_t value = 0;
     uint64_t expectedValue = 0;
@@ -149,7 +191,7 @@ Test::GetStatusRegErrors()
 
 
     // PCI STS register may indicate some error
-    if (gRegisters->Read(PCISPC_STS, value) == false)
+    if (regs.Get(PCISPC_STS, value) == false)
         return false;
     expectedValue = (value & ~((uint64_t)gCmdLine.errRegs.sts));
     if (value != expectedValue) {
@@ -163,7 +205,7 @@ Test::GetStatusRegErrors()
     // Other optional PCI errors
     for (uint16_t i = 0; i < cap->size(); i++) {
         if (cap->at(i) == PCICAP_PXCAP) {
-            if (gRegisters->Read(PCISPC_PXDS, value) == false)
+            if (regs.Get(PCISPC_PXDS, value) == false)
                 return false;
             expectedValue = (value & ~((uint64_t)gCmdLine.errRegs.pxds));
             if (value != expectedValue) {
@@ -173,7 +215,7 @@ Test::GetStatusRegErrors()
                 return false;
             }
         } else if (cap->at(i) == PCICAP_AERCAP) {
-            if (gRegisters->Read(PCISPC_AERUCES, value) == false)
+            if (regs.Get(PCISPC_AERUCES, value) == false)
                 return false;
             expectedValue = (value & ~((uint64_t)gCmdLine.errRegs.aeruces));
             if (value != expectedValue) {
@@ -187,7 +229,7 @@ Test::GetStatusRegErrors()
 
 
     // Ctrl'r STS register may indicate some error
-    if (gRegisters->Read(CTLSPC_CSTS, value) == false)
+    if (regs.Get(CTLSPC_CSTS, value) == false)
         return false;
     expectedValue = (value & ~((uint64_t)gCmdLine.errRegs.csts));
     if (value != expectedValue) {
@@ -179,15 +179,20 @@ protected:
     /**
      * Resets the sticky error bits of the PCI address space. Prior errors
      * should not cause errors in subsequent tests, resetting to avoid
-     * incorrectly detected errors.
+     * incorrectly detected errors. Only those registers which have sticky
+     * bits set are written.
+     * @param regs Pass a snapshot of the registers taken prior to the test
+     * @return true if any register was written, thus regs is now stale
      */
-    void ResetStatusRegErrors();
+    bool ResetStatusRegErrors(const RegSnapshot &regs);
 
     /**
      * Check PCI and ctrl'r registers status registers for errors which may
      * be present.
+     * @param regs Pass a snapshot of the registers taken after the test
+     * @return true if no errors are indicated, otherwise false
      */
-    bool GetStatusRegErrors();
+    bool GetStatusRegErrors(const RegSnapshot &regs);
 
     /**
      * Report bit position of val which is not like expectedVal
@@ -30,6 +30,9 @@
 #include "globals.h"
 #include "Utils/kernelAPI.h"
 #include "Utils/fileSystem.h"
+#include "Utils/cmdLatency.h"
+#include "Utils/bufferPool.h"
+#include "Utils/traceLog.h"
 
 
 // ------------------------------EDIT HERE---------------------------------
@@ -58,6 +61,7 @@
 #include "GrpAdminGetFeatCmd/grpAdminGetFeatCmd.h"
 #include "GrpAdminSetGetFeatCombo/grpAdminSetGetFeatCombo.h"
 #include "GrpAdminAsyncCmd/grpAdminAsyncCmd.h"
+#include "GrpPerfBenchmark/grpPerfBenchmark.h"
 
 
 void
@@ -93,6 +97,9 @@ InstantiateGroups(vector<Group *> &groups)
     groups.push_back(new GrpAdminGetFeatCmd::GrpAdminGetFeatCmd(groups.size()));
     groups.push_back(new GrpAdminSetGetFeatCombo::GrpAdminSetGetFeatCombo(groups.size()));
     groups.push_back(new GrpAdminAsyncCmd::GrpAdminAsyncCmd(groups.size()));
+    // Following is assigned grp ID=25, only when requested, see -x(--perf)
+    if (gCmdLine.perf.req)
+        groups.push_back(new GrpPerfBenchmark::GrpPerfBenchmark(groups.size()));
 }
 // ------------------------------EDIT HERE---------------------------------
 
@@ -100,6 +107,11 @@ InstantiateGroups(vector<Group *> &groups)
 #define BASE_DUMP_DIR           "./Logs"
 #define NO_DEVICES              "no devices found"
 #define INFORM_GRPNUM           0
+#define DFLT_PERF_NUM_BLKS      8
+#define DFLT_PERF_QDEPTH        32
+#define DFLT_PERF_NUM_QPAIRS    1
+#define DFLT_PERF_SECONDS       10
+#define DFLT_HUGEPAGE_MIB       64
 
 
 void Usage(void);
@@ -145,6 +157,8 @@ Usage(void) {
     printf("                                      fileOut, optional file for results output\n");
     printf("  -n(--postfail)                      Upon test failure, instruct framework to\n");
     printf("                                      take a post failure snapshot of the DUT\n");
+    printf("                                      Also render the dumps of passing tests,\n");
+    printf("                                      otherwise only failing tests dump files\n");
     printf("  -b(--rsvdfields)                    Execute the optional reserved field\n");
     printf("                                      tests; verifying fields are zero value\n");
     printf("  -y(--restore)                       Upon test failure, allow an individual\n");
@@ -155,6 +169,50 @@ Usage(void) {
     printf("                                      Recommend supply identical FW image as\n");
     printf("                                      current test image.\n");
     printf("                      --- Advanced/Debug Options Follow ---\n");
+    printf("  -j(--hugepages) [<MiB>]             Reserve a <MiB> arena of 2MB hugepages,\n");
+    printf("                                      mlock'd up front, to back large data\n");
+    printf("                                      xfer buffers; falls back to regular\n");
+    printf("                                      pages when unavailable; dflt=%d\n",
+        DFLT_HUGEPAGE_MIB);
+    printf("  -L(--loglevel) <lvl>[,<sub>:<lvl>]  Most verbose log level, <lvl>={err | warn\n");
+    printf("                                      | nrm | dbg}, optionally overridden per\n");
+    printf("                                      subsystem <sub>={general | queues |\n");
+    printf("                                      regs | cmds}; dflt=nrm\n");
+    printf("  -F(--logflush) <lazy | err | sync>  Policy to flush queued log lines; lazy\n");
+    printf("                                      waits for exit, err flushes upon every\n");
+    printf("                                      error/failure, sync writes each line\n");
+    printf("                                      immediately; dflt=err\n");
+    printf("  -T(--trace) <MiB>                   Record hot path events into a binary\n");
+    printf("                                      trace ring of <MiB> in the dump dir,\n");
+    printf("                                      rather than logging them as text.\n");
+    printf("                                      Render via tnvme-trace; dflt=0=off\n");
+    printf("  -Z(--dumpgz) <KiB>                  Hex dumps of buffers >= <KiB> are gzip'd\n");
+    printf("                                      into a companion <dumpfile>.gz;\n");
+    printf("                                      dflt=0=never\n");
+    printf("  -D(--dumpasync)                     Between groups rename the populated dump\n");
+    printf("                                      dir to a timestamped *.stale dir and\n");
+    printf("                                      delete it in the background\n");
+    printf("  -I(--idcache)                       Adopt the identify namspc data cached\n");
+    printf("                                      in <dump>/informative.idcache when the\n");
+    printf("                                      identify ctrlr data matches, rather\n");
+    printf("                                      than fetching it; a format done outside\n");
+    printf("                                      of tnvme goes unnoticed\n");
+    printf("  -c(--cqwait) <poll | adaptive>      Strategy to wait upon CE's to arrive;\n");
+    printf("                                      adaptive spins briefly before backing\n");
+    printf("                                      off exponentially; dflt=poll\n");
+    printf("  -x(--perf) [<blks:qd:qpairs:sec[:rd[:seq|rand]]>]\n");
+    printf("                                      Run GrpPerfBenchmark, it is otherwise\n");
+    printf("                                      not instantiated. Workload params are\n");
+    printf("                                      logical blks per cmd, cmds outstanding\n");
+    printf("                                      per Q pair, num of IOQ pairs, seconds\n");
+    printf("                                      per workload. Require base 10 values.\n");
+    printf("                                      dflt=%d:%d:%d:%d\n", DFLT_PERF_NUM_BLKS,
+        DFLT_PERF_QDEPTH, DFLT_PERF_NUM_QPAIRS, DFLT_PERF_SECONDS);
+    printf("                                      Optional <rd> is the %% of reads [0-100]\n");
+    printf("                                      and seq|rand the LBA pattern, both\n");
+    printf("                                      apply to every test, otherwise each\n");
+    printf("                                      test's own mix is used. An empty <rd>\n");
+    printf("                                      keeps each test's own %% of reads.\n");
     printf("  -e(--error) <STS:PXDS:AERUCES:CSTS> Set reg bitmask for bits indicating error\n");
     printf("                                      state after each test completes.\n");
     printf("                                      Value=0 indicates ignore all errors.\n");
@@ -196,7 +254,7 @@ main(int argc, char *argv[])
     bool deviceFound = false;
     bool accessingHdw = true;
     uint64_t regVal = 0;
-    const char *short_opt = "hsnblpyzia::t::v:o:d:k:f:r:w:q:e:m:u:g:";
+    const char *short_opt = "hsnblpyziDIa::j::t::x::v:o:d:k:f:r:w:q:e:m:u:g:c:L:F:T:Z:";
     static struct option long_opt[] = {
         // {name,           has_arg,            flag,   val}
         {   "detail",       optional_argument,  NULL,   'a'},
@@ -214,6 +272,12 @@ main(int argc, char *argv[])
         {   "dump",         required_argument,  NULL,   'u'},
         {   "golden",       required_argument,  NULL,   'g'},
         {   "fwimage",      required_argument,  NULL,   'm'},
+        {   "cqwait",       required_argument,  NULL,   'c'},
+        {   "perf",         optional_argument,  NULL,   'x'},
+        {   "loglevel",     required_argument,  NULL,   'L'},
+        {   "logflush",     required_argument,  NULL,   'F'},
+        {   "trace",        required_argument,  NULL,   'T'},
+        {   "dumpgz",       required_argument,  NULL,   'Z'},
 
         {   "help",         no_argument,        NULL,   'h'},
         {   "summary",      no_argument,        NULL,   's'},
@@ -224,6 +288,9 @@ main(int argc, char *argv[])
         {   "ignore",       no_argument,        NULL,   'i'},
         {   "postfail",     no_argument,        NULL,   'n'},
         {   "rsvdfields",   no_argument,        NULL,   'b'},
+        {   "hugepages",    optional_argument,  NULL,   'j'},
+        {   "dumpasync",    no_argument,        NULL,   'D'},
+        {   "idcache",      no_argument,        NULL,   'I'},
         {   NULL,           no_argument,        NULL,    0}
     };
 
@@ -235,6 +302,17 @@ main(int argc, char *argv[])
     gCmdLine.errRegs.pxds = (PXDS_TP | PXDS_FED);
     gCmdLine.errRegs.csts = CSTS_CFS;
     gCmdLine.dump = BASE_DUMP_DIR;
+    gCmdLine.cqWait = CQWAIT_POLL;
+    gCmdLine.perf.req = false;
+    gCmdLine.perf.numBlks = DFLT_PERF_NUM_BLKS;
+    gCmdLine.perf.qDepth = DFLT_PERF_QDEPTH;
+    gCmdLine.perf.numQPairs = DFLT_PERF_NUM_QPAIRS;
+    gCmdLine.perf.seconds = DFLT_PERF_SECONDS;
+    gCmdLine.perf.readPct = -1;
+    gCmdLine.perf.pattern = PERFPAT_TEST;
+    for (int i = 0; i < LOGSUB_FENCE; i++)
+        gCmdLine.log.level[i] = LOGLVL_NRM;
+    gCmdLine.log.flush = LOGFLUSH_ERR;
 
     if (argc == 1) {
         printf("%s is a compliance test suite for NVM Express hardware.\n",
@@ -386,6 +464,16 @@ main(int argc, char *argv[])
             }
             break;
 
+        case 'x':
+            gCmdLine.perf.req = true;
+            if (optarg == NULL)
+                break;
+            if (ParsePerfCmdLine(gCmdLine.perf, optarg) == false) {
+                printf("Unable to parse --perf cmd line\n");
+                exit(1);
+            }
+            break;
+
         case 's':
             gCmdLine.summary = true;
             accessingHdw = false;
@@ -395,6 +483,69 @@ main(int argc, char *argv[])
             gCmdLine.dump = optarg;
             break;
 
+        case 'c':
+            work = optarg;
+            if (work.compare("poll") == 0) {
+                gCmdLine.cqWait = CQWAIT_POLL;
+            } else if (work.compare("adaptive") == 0) {
+                gCmdLine.cqWait = CQWAIT_ADAPTIVE;
+            } else {
+                printf("Unable to parse --cqwait cmd line\n");
+                exit(1);
+            }
+            break;
+
+        case 'L':
+            if (ParseLogCmdLine(gCmdLine.log, optarg) == false) {
+                printf("Unable to parse --loglevel cmd line\n");
+                exit(1);
+            }
+            break;
+
+        case 'F':
+            work = optarg;
+            if (work.compare("lazy") == 0) {
+                gCmdLine.log.flush = LOGFLUSH_LAZY;
+            } else if (work.compare("err") == 0) {
+                gCmdLine.log.flush = LOGFLUSH_ERR;
+            } else if (work.compare("sync") == 0) {
+                gCmdLine.log.flush = LOGFLUSH_SYNC;
+            } else {
+                printf("Unable to parse --logflush cmd line\n");
+                exit(1);
+            }
+            break;
+
+        case 'T':
+            tmp = strtol(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (tmp < 0) || (tmp > 0x10000)) {
+                printf("Unrecognized --trace <MiB>=%s\n", optarg);
+                exit(1);
+            }
+            gCmdLine.trace = tmp;
+            break;
+
+        case 'Z':
+            tmp = strtol(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (tmp < 0) || (tmp > 0x400000)) {
+                printf("Unrecognized --dumpgz <KiB>=%s\n", optarg);
+                exit(1);
+            }
+            gCmdLine.dumpGz = tmp;
+            break;
+
+        case 'j':
+            gCmdLine.hugePages = DFLT_HUGEPAGE_MIB;
+            if (optarg == NULL)
+                break;
+            tmp = strtol(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (tmp <= 0) || (tmp > 0x10000)) {
+                printf("Unrecognized --hugepages <MiB>=%s\n", optarg);
+                exit(1);
+            }
+            gCmdLine.hugePages = tmp;
+            break;
+
         default:
         case 'h':   Usage();                            exit(0);
         case '?':   Usage();                            exit(1);
@@ -404,6 +555,8 @@ main(int argc, char *argv[])
         case 'n':   gCmdLine.postfail = true;           break;
         case 'b':   gCmdLine.rsvdfields = true;         break;
         case 'y':   gCmdLine.restore = true;            break;
+        case 'D':   gCmdLine.dumpAsync = true;          break;
+        case 'I':   gCmdLine.idCache = true;            break;
         }
     }
 
@@ -417,6 +570,13 @@ main(int argc, char *argv[])
         exit(1);
     }
 
+    // Logging moves off the hot path from here on
+    for (int i = 0; i < LOGSUB_FENCE; i++)
+        Logger::SetLevel((LogSubsys)i, gCmdLine.log.level[i]);
+    Logger::SetFlushPolicy(gCmdLine.log.flush);
+    if (Logger::Start() == false)
+        LOG_WARN("Unable to start the log writer, logging synchronously");
+
     try {   // Everything below has the ability to throw exceptions
 
         // Instantiates and initializes all globals defined within globals.h
@@ -438,6 +598,17 @@ main(int argc, char *argv[])
                 exit(1);
             }
 
+            if (gCmdLine.hugePages) {
+                BufferPool::AddHugePageArena(
+                    (uint64_t)gCmdLine.hugePages * 1024 * 1024);
+            }
+
+            if (gCmdLine.trace && (TraceLog::Start(gCmdLine.dump +
+                "/tnvme.trace", gCmdLine.trace) == false)) {
+                printf("Unable to start binary tracing\n");
+                exit(1);
+            }
+
             printf("Checking for unintended device under low powered states\n");
             if (gRegisters->Read(PCISPC_PMCS, regVal) == false) {
                 printf("Mandatory PMCAP PCI capabilities is missing\n");
@@ -524,7 +695,11 @@ main(int argc, char *argv[])
             // At this point we cannot enable the ctrlr because that requires
             // ACQ/ASQ's to be created, ctrlr simply won't become ready w/o them
         } else if (gCmdLine.test.req) {
-            if ((exitCode = !ExecuteTests(gCmdLine, groups))) {
+            exitCode = !ExecuteTests(gCmdLine, groups);
+            CmdLatency::LogRun();
+            BufferPool::LogStats();
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: testing\n");
             } else {
                 printf("SUCCESS: testing\n");
@@ -535,6 +710,8 @@ main(int argc, char *argv[])
     }
 
     // cleanup duties
+    TraceLog::Stop();
+    FileSystem::Drain();
     DestroyTestFoundation(groups);
     DestroySingletons();
     gCmdLine.skiptest.clear();
@@ -22,6 +22,7 @@
 #include <vector>
 #include "dnvme.h"
 #include "testRef.h"
+#include "Utils/logger.h"
 
 using namespace std;
 
@@ -30,16 +31,26 @@ using namespace std;
 
 #define APPNAME         "tnvme"
 #define LEVEL           APPNAME
+// Lines are filtered and queued to the writer thread by Utils/logger.h
+#define LOG_EMIT(lvl, fmt, ...)                         \
+    do {                                                \
+        if (Logger::IsEnabled(lvl, LOG_SUBSYS))         \
+            Logger::Log(lvl, fmt, ## __VA_ARGS__);      \
+    } while (0)
 #define LOG_NRM(fmt, ...)       \
-    fprintf(stderr, "%s:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    LOG_EMIT(LOGLVL_NRM, "%s:%s:%d: " fmt "\n", LEVEL, HERE,   \
+        ## __VA_ARGS__);
 #define LOG_ERR(fmt, ...)       \
-    fprintf(stderr, "%s-err:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    LOG_EMIT(LOGLVL_ERR, "%s-err:%s:%d: " fmt "\n", LEVEL, HERE,   \
+        ## __VA_ARGS__);
 #define LOG_WARN(fmt, ...)      \
-    fprintf(stderr, "%s-warn:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    LOG_EMIT(LOGLVL_WARN, "%s-warn:%s:%d: " fmt "\n", LEVEL, HERE,   \
+        ## __VA_ARGS__);
 
 #ifdef DEBUG
 #define LOG_DBG(fmt, ...)       \
-    fprintf(stderr, "%s-dbg:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    LOG_EMIT(LOGLVL_DBG, "%s-dbg:%s:%d: " fmt "\n", LEVEL, HERE,   \
+        ## __VA_ARGS__);
 #else
 #define LOG_DBG(fmt, ...)       ;
 #endif
@@ -78,11 +89,28 @@ typedef enum {
     DATAPAT_INC_8BIT,
     DATAPAT_INC_16BIT,
     DATAPAT_INC_32BIT,
+    DATAPAT_INC_64BIT,
 
     DATAPATTERN_FENCE           // always must be last element
 } DataPattern;
 
 
+typedef enum {
+    CQWAIT_POLL,                // poll w/ a constant sleep between inquiries
+    CQWAIT_ADAPTIVE,            // spin, then poll w/ an exponential backoff
+
+    CQWAIT_FENCE                // always must be last element
+} CQWait;
+
+typedef enum {
+    PERFPAT_TEST,               // each test's own access pattern
+    PERFPAT_SEQ,                // sequential LBA's for every test
+    PERFPAT_RAND,               // random LBA's for every test
+
+    PERFPAT_FENCE               // always must be last element
+} PerfPattern;
+
+
 /**
  * Combination/permutation not listed below should be considered illegal. The
  * last permutation listed, request spec'd test within spec'd group, causes
@@ -158,6 +186,21 @@ struct Golden {
     vector<IdentifyDUT> cmds;   // Array of identify cmd data to validate
 };
 
+struct PerfParams {
+    bool                req;        // Requested by cmd line
+    uint32_t            numBlks;    // Number of logical blocks per cmd
+    uint32_t            qDepth;     // Max cmds outstanding per queue pair
+    uint16_t            numQPairs;  // Number of IOSQ/IOCQ pairs to drive
+    uint32_t            seconds;    // Duration of each workload
+    int16_t             readPct;    // [0 - 100] % reads, < 0 each test's own
+    PerfPattern         pattern;    // Access pattern of every workload
+};
+
+struct LogParams {
+    LogLevel            level[LOGSUB_FENCE];    // Most verbose level logged
+    LogFlush            flush;      // How much may stay queued upon errors
+};
+
 struct FWImage {
     bool                req;    // Requested by cmd line
     vector<uint8_t>     data;   // Array of raw FW binary bytes to program
@@ -172,6 +215,8 @@ struct CmdLine {
     bool            postfail;
     bool            rsvdfields;
     bool            preserve;
+    bool            dumpAsync;
+    bool            idCache;
     size_t          loop;
     SpecRev         rev;
     TestTarget      detail;
@@ -186,6 +231,12 @@ struct CmdLine {
     NumQueues       numQueues;
     ErrorRegs       errRegs;
     string          dump;
+    CQWait          cqWait;
+    PerfParams      perf;
+    LogParams       log;
+    uint32_t        trace;      // MiB of binary trace ring, 0 = disabled
+    uint32_t        dumpGz;     // KiB at which hex dumps gzip, 0 = never
+    uint32_t        hugePages;  // MiB of hugepage arena, 0 = disabled
 };
 
 
@@ -31,6 +31,7 @@ rm -rf $RPM_BUILD_ROOT
 %files
 %defattr(755,root,root,755)
 %{_bindir}/%{name}
+%{_bindir}/%{name}-trace
 
 %post
 
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "globals.h"
+#include "Utils/buffers.h"
+#include "Utils/patternGen.h"
+
+#define BENCH_APPNAME   "tnvme-bench"
+#define DFLT_SIZE_KIB   1024
+#define DFLT_ITERS      16
+
+
+void
+Usage(void) {
+    //80->  xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    printf("%s: micro benchmarks of tnvme's host side hot paths, no DUT needed\n", BENCH_APPNAME);
+    printf("usage: %s [options]\n", BENCH_APPNAME);
+    printf("  -h(--help)                          Display this help\n");
+    printf("  -s(--size) <KiB>                    Size of the buffer each iteration\n");
+    printf("                                      processes; dflt=%d\n", DFLT_SIZE_KIB);
+    printf("  -i(--iters) <count>                 Number of iterations timed per\n");
+    printf("                                      benchmark; dflt=%d\n", DFLT_ITERS);
+}
+
+
+/// @return A monotonic timestamp in ns
+static uint64_t
+NowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec);
+}
+
+
+/// Log the throughput of processing numBytes within ns
+static void
+Report(const char *name, uint64_t numBytes, uint64_t ns)
+{
+    printf("  %-28s %10.1f MiB/s  %10.3f ms\n", name,
+        ((double)numBytes / (1024.0 * 1024.0)) / ((double)ns / 1e9),
+        ((double)ns / 1e6));
+}
+
+
+/**
+ * The hex dump formatter which Buffers::RenderHex() replaced, 1 snprintf()
+ * per byte and 1 fprintf() per row, kept verbatim as the baseline.
+ */
+static void
+RenderHexPerByte(FILE *fp, const uint8_t *data, size_t dumpLen,
+    const string &fileHdr)
+{
+    const int BUF_SIZE = 20;
+    char work[BUF_SIZE];
+    string output;
+
+
+    fprintf(fp, "%s\n", fileHdr.c_str());
+    for (unsigned long i = 0; i < dumpLen; i++) {
+        if ((i % 16) == 15) {
+            snprintf(work, BUF_SIZE, " %02X\n", *data++);
+            output += work;
+            fprintf(fp, "%s", output.c_str());
+            output.clear();
+        } else if ((i % 16) == 0) {
+            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
+            output += work;
+        } else {
+            snprintf(work, BUF_SIZE, " %02X", *data++);
+            output += work;
+        }
+    }
+    if (output.length() != 0)
+        fprintf(fp, "%s\n", output.c_str());
+}
+
+
+/**
+ * Time the per byte snprintf() hex dump against Buffers::RenderHex(), after
+ * proving both render identical text.
+ * @return true upon success, otherwise false
+ */
+static bool
+BenchHexDump(const uint8_t *buf, uint32_t size, uint32_t iters)
+{
+    const string hdr = "bench";
+    char *oldTxt, *newTxt;
+    size_t oldLen, newLen;
+    uint64_t start, ns;
+
+    printf("Hex dump rendering of %u bytes\n", size);
+    FILE *oldFp = open_memstream(&oldTxt, &oldLen);
+    FILE *newFp = open_memstream(&newTxt, &newLen);
+    if ((oldFp == NULL) || (newFp == NULL)) {
+        printf("Unable to open memory streams\n");
+        return false;
+    }
+    RenderHexPerByte(oldFp, buf, size, hdr);
+    Buffers::RenderHex(newFp, "", buf, size, false, hdr);
+    fclose(oldFp);
+    fclose(newFp);
+    bool same = ((oldLen == newLen) && (memcmp(oldTxt, newTxt, oldLen) == 0));
+    free(oldTxt);
+    free(newTxt);
+    if (same == false) {
+        printf("Buffers::RenderHex() renders differently than its baseline\n");
+        return false;
+    }
+
+    // Writing to /dev/null times the formatting, not the storage
+    FILE *fp = fopen("/dev/null", "w");
+    if (fp == NULL) {
+        printf("Unable to open /dev/null\n");
+        return false;
+    }
+    start = NowNs();
+    for (uint32_t i = 0; i < iters; i++)
+        RenderHexPerByte(fp, buf, size, hdr);
+    ns = (NowNs() - start);
+    Report("snprintf() per byte", ((uint64_t)size * iters), ns);
+
+    start = NowNs();
+    for (uint32_t i = 0; i < iters; i++)
+        Buffers::RenderHex(fp, "", buf, size, false, hdr);
+    ns = (NowNs() - start);
+    Report("Buffers::RenderHex()", ((uint64_t)size * iters), ns);
+    fclose(fp);
+    return true;
+}
+
+
+/**
+ * Time every pattern with every kernel the CPU supports, after proving each
+ * kernel generates exactly what the scalar kernel generates.
+ * @return true upon success, otherwise false
+ */
+static bool
+BenchPatternGen(uint8_t *buf, uint32_t size, uint32_t iters)
+{
+    static const char *patName[] = {
+        "const 8b", "const 16b", "const 32b",
+        "inc 8b", "inc 16b", "inc 32b", "inc 64b"
+    };
+    static const char *kernelName[] = { "scalar", "sse2", "avx2" };
+    vector<uint8_t> expected(size);
+    char name[64];
+
+    printf("Pattern generation of %u bytes\n", size);
+    for (int pat = 0; pat < DATAPATTERN_FENCE; pat++) {
+        PatternGen::Fill(PatternGen::KERNEL_SCALAR, (DataPattern)pat,
+            0x0123456789ABCDEFULL, &expected[0], size);
+
+        for (int k = 0; k < PatternGen::KERNEL_FENCE; k++) {
+            PatternGen::Kernel kernel = (PatternGen::Kernel)k;
+            if (PatternGen::IsSupported(kernel) == false)
+                continue;
+
+            memset(buf, 0, size);
+            PatternGen::Fill(kernel, (DataPattern)pat, 0x0123456789ABCDEFULL,
+                buf, size);
+            if (memcmp(buf, &expected[0], size) != 0) {
+                printf("Kernel %s miscompares w/ scalar for pattern %s\n",
+                    kernelName[k], patName[pat]);
+                return false;
+            }
+
+            uint64_t start = NowNs();
+            for (uint32_t i = 0; i < iters; i++) {
+                PatternGen::Fill(kernel, (DataPattern)pat, i, buf, size);
+            }
+            snprintf(name, sizeof(name), "%s, %s", patName[pat],
+                kernelName[k]);
+            Report(name, ((uint64_t)size * iters), (NowNs() - start));
+        }
+    }
+    return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int c;
+    int idx = 0;
+    char *endptr;
+    unsigned long sizeKiB = DFLT_SIZE_KIB;
+    unsigned long iters = DFLT_ITERS;
+    const char *short_opt = "hs:i:";
+    static struct option long_opt[] = {
+        // {name,           has_arg,            flag,   val}
+        {   "help",         no_argument,        NULL,   'h'},
+        {   "size",         required_argument,  NULL,   's'},
+        {   "iters",        required_argument,  NULL,   'i'},
+        {   NULL,           no_argument,        NULL,    0}
+    };
+
+    while ((c = getopt_long(argc, argv, short_opt, long_opt, &idx)) != -1) {
+        switch (c) {
+        case 's':
+            sizeKiB = strtoul(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (sizeKiB == 0) ||
+                (sizeKiB > (UINT32_MAX / 1024))) {
+                printf("Unrecognized --size <KiB>=%s\n", optarg);
+                exit(1);
+            }
+            break;
+        case 'i':
+            iters = strtoul(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (iters == 0) || (iters > UINT32_MAX)) {
+                printf("Unrecognized --iters <count>=%s\n", optarg);
+                exit(1);
+            }
+            break;
+        case 'h':   Usage();                            exit(0);
+        default:    Usage();                            exit(1);
+        }
+    }
+    if (optind != argc) {
+        Usage();
+        exit(1);
+    }
+
+    uint32_t size = (uint32_t)(sizeKiB * 1024);
+    vector<uint8_t> buf(size);
+    for (uint32_t i = 0; i < size; i++)
+        buf[i] = (uint8_t)((i * 131) + (i >> 8));
+
+    if (BenchHexDump(&buf[0], size, iters) == false)
+        exit(1);
+    if (BenchPatternGen(&buf[0], size, iters) == false)
+        exit(1);
+    return 0;
+}
@@ -306,6 +306,8 @@ FormatDevice(Format &format)
             formatNVM->SetMS(format.cmds[i].ms);
             formatNVM->SetLBAF(format.cmds[i].lbaf);
 
+            // Namspc identify data is about to change, SN/MN/FR will not
+            Informative::InvalidateCache();
             IO::SendAndReapCmd("tnvme", "format", CALC_TIMEOUT_ms(1),
                 asq, acq, formatNVM, "", true);
         }
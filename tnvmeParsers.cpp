@@ -1156,3 +1156,117 @@ ParseQueuesCmdLine(NumQueues &numQueues, const char *optarg)
 
     return true;
 }
+
+
+bool
+ParsePerfCmdLine(PerfParams &perf, const char *optarg)
+{
+    size_t pos;
+    char *endptr;
+    string swork;
+    string token;
+    unsigned long tmp[4];
+    const char *name[] = { "<blks>", "<qd>", "<qpairs>", "<sec>" };
+    const unsigned long max[] = { 0x10000, 0xFFFF, 0xFFFF, 86400 };
+
+    // Parsing <blks:qd:qpairs:sec[:rd[:seq|rand]]>
+    swork = optarg;
+    for (int i = 0; i < 4; i++) {
+        if (swork.length() == 0) {
+            LOG_ERR("Missing %s format string", name[i]);
+            return false;
+        }
+        tmp[i] = strtoul(swork.c_str(), &endptr, 10);
+        if ((*endptr != ':') && (*endptr != '\0')) {
+            LOG_ERR("Unrecognized format <blks:qd:qpairs:sec>=%s", optarg);
+            return false;
+        } else if ((*endptr == '\0') && (i < 3)) {
+            LOG_ERR("Missing %s format string", name[i + 1]);
+            return false;
+        } else if ((tmp[i] == 0) || (tmp[i] > max[i])) {
+            LOG_ERR("%s outside allowed range of 1 to %ld", name[i], max[i]);
+            return false;
+        }
+        pos = swork.find_first_of(':');
+        swork = (pos == string::npos) ? "" : swork.substr(pos + 1);
+    }
+
+    perf.numBlks = (uint32_t)tmp[0];
+    perf.qDepth = (uint32_t)tmp[1];
+    perf.numQPairs = (uint16_t)tmp[2];
+    perf.seconds = (uint32_t)tmp[3];
+
+    // Optional <rd>, an empty value keeps each test's own % of reads
+    pos = swork.find_first_of(':');
+    token = swork.substr(0, pos);
+    swork = (pos == string::npos) ? "" : swork.substr(pos + 1);
+    if (token.length()) {
+        tmp[0] = strtoul(token.c_str(), &endptr, 10);
+        if ((*endptr != '\0') || (tmp[0] > 100)) {
+            LOG_ERR("<rd> outside allowed range of 0 to 100: %s",
+                token.c_str());
+            return false;
+        }
+        perf.readPct = (int16_t)tmp[0];
+    }
+
+    // Optional <seq|rand>
+    if (swork.length()) {
+        if (swork.compare("seq") == 0) {
+            perf.pattern = PERFPAT_SEQ;
+        } else if (swork.compare("rand") == 0) {
+            perf.pattern = PERFPAT_RAND;
+        } else {
+            LOG_ERR("Unrecognized LBA pattern <seq|rand>=%s", swork.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool
+ParseLogCmdLine(LogParams &log, const char *optarg)
+{
+    size_t pos;
+    string swork;
+    string token;
+    LogLevel lvl;
+    LogSubsys sub;
+
+    // Parsing <lvl>[,<subsys>:<lvl>]...
+    swork = optarg;
+    for (bool first = true; swork.length(); first = false) {
+        pos = swork.find_first_of(',');
+        token = swork.substr(0, pos);
+        swork = (pos == string::npos) ? "" : swork.substr(pos + 1);
+
+        if (first) {
+            if ((lvl = Logger::GetLevel(token)) == LOGLVL_FENCE) {
+                LOG_ERR("Unrecognized log level: %s", token.c_str());
+                return false;
+            }
+            for (int i = 0; i < LOGSUB_FENCE; i++)
+                log.level[i] = lvl;
+            continue;
+        }
+
+        pos = token.find_first_of(':');
+        if (pos == string::npos) {
+            LOG_ERR("Unrecognized format <subsys>:<lvl>=%s", token.c_str());
+            return false;
+        } else if ((sub = Logger::GetSubsys(token.substr(0, pos))) ==
+            LOGSUB_FENCE) {
+            LOG_ERR("Unrecognized log subsystem: %s",
+                token.substr(0, pos).c_str());
+            return false;
+        } else if ((lvl = Logger::GetLevel(token.substr(pos + 1))) ==
+            LOGLVL_FENCE) {
+            LOG_ERR("Unrecognized log level: %s",
+                token.substr(pos + 1).c_str());
+            return false;
+        }
+        log.level[sub] = lvl;
+    }
+    return true;
+}
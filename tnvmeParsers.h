@@ -31,6 +31,8 @@ bool ParseRmmapCmdLine(RmmapIo &rmmap, const char *optarg);
 bool ParseWmmapCmdLine(WmmapIo &wmmap, const char *optarg);
 bool ParseQueuesCmdLine(NumQueues &numQueues, const char *optarg);
 bool ParseErrorCmdLine(ErrorRegs &errRegs, const char *optarg);
+bool ParsePerfCmdLine(PerfParams &perf, const char *optarg);
+bool ParseLogCmdLine(LogParams &log, const char *optarg);
 bool SeekSpecificXMLNode(xmlpp::TextReader &xmlFile, string nodeName,
     int nodeDepth, string &nodeVal, vector<string> &nodeAttrib);
 bool ExtractFormatXMLValue(xmlpp::TextReader &xmlFile, FormatDUT &cmd,
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Utils/traceFmt.h"
+
+#define APPNAME         "tnvme-trace"
+
+
+void
+Usage(void) {
+    //80->  xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    printf("%s: render a tnvme binary trace file, oldest record 1st\n", APPNAME);
+    printf("usage: %s [options] <tracefile>\n", APPNAME);
+    printf("  -h(--help)                          Display this help\n");
+    printf("  -j(--json)                          Render 1 JSON object per line rather\n");
+    printf("                                      than the text tnvme would have logged\n");
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int c;
+    int idx = 0;
+    bool json = false;
+    const char *short_opt = "hj";
+    static struct option long_opt[] = {
+        // {name,           has_arg,            flag,   val}
+        {   "help",         no_argument,        NULL,   'h'},
+        {   "json",         no_argument,        NULL,   'j'},
+        {   NULL,           no_argument,        NULL,    0}
+    };
+
+    while ((c = getopt_long(argc, argv, short_opt, long_opt, &idx)) != -1) {
+        switch (c) {
+        case 'j':   json = true;                        break;
+        case 'h':   Usage();                            exit(0);
+        default:    Usage();                            exit(1);
+        }
+    }
+    if (optind != (argc - 1)) {
+        Usage();
+        exit(1);
+    }
+
+    const char *filename = argv[optind];
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if ((fd < 0) || (fstat(fd, &st) != 0)) {
+        printf("Unable to open trace file: %s\n", filename);
+        exit(1);
+    } else if ((size_t)st.st_size < TRACE_HDR_SIZE) {
+        printf("Trace file is too small to be valid: %s\n", filename);
+        exit(1);
+    }
+
+    uint8_t *map = (uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+        fd, 0);
+    if (map == MAP_FAILED) {
+        printf("Unable to map trace file: %s\n", filename);
+        exit(1);
+    }
+    const TraceHdr *hdr = (const TraceHdr *)map;
+    if (memcmp(hdr->magic, TRACE_MAGIC, sizeof(hdr->magic)) != 0) {
+        printf("Not a tnvme trace file: %s\n", filename);
+        exit(1);
+    } else if ((hdr->version != TRACE_VERSION) ||
+        (hdr->recSize != sizeof(TraceRec))) {
+        printf("Unsupported trace file version %d, record size %d\n",
+            hdr->version, hdr->recSize);
+        exit(1);
+    }
+
+    // Once the ring wrapped the oldest surviving record follows the newest
+    const TraceRec *recs = (const TraceRec *)(map + TRACE_HDR_SIZE);
+    uint64_t numAvail = ((st.st_size - TRACE_HDR_SIZE) / sizeof(TraceRec));
+    uint64_t numRecs = hdr->numRecs;
+    uint64_t first = 0;
+    if (numRecs > hdr->numSlots)
+        first = (numRecs - hdr->numSlots);
+    if (numAvail > hdr->numSlots)
+        numAvail = hdr->numSlots;
+
+    for (uint64_t i = first; i < numRecs; i++) {
+        uint64_t slot = (i & (hdr->numSlots - 1));
+        if (slot >= numAvail)
+            continue;
+        string line = json ? TraceFmt::RenderJSON(recs[slot]) :
+            TraceFmt::RenderText(recs[slot]);
+        if (line.empty())
+            continue;   // never completely written, i.e. a crash
+        fwrite(line.c_str(), 1, line.length(), stdout);
+        fputc('\n', stdout);
+    }
+
+    munmap(map, st.st_size);
+    close(fd);
+    return 0;
+}